@@ -36,16 +36,27 @@
 #
 # After scanning the database, results will be served over HTTP in JSON format
 # so they can be consumed by the Infinity data source in Grafana.
+#
+# The index is persisted to a JSON file (--index-file) and updated
+# incrementally: on restart, only the range since the last scan (plus an
+# overlap window to pick up jobs that were still running) is scanned. The
+# same file can be used by omnistat-query (job_index in the [omnistat.query]
+# section) to find the time range of indexed jobs without scanning.
 
 import argparse
 import asyncio
 import http.server
 import json
+import os
 import sys
+import threading
 import time
 
 import aiohttp
 
+INDEX_VERSION = 1
+SECONDS_PER_HOUR = 60 * 60
+
 
 class JobIndexHandler(http.server.BaseHTTPRequestHandler):
     """
@@ -115,29 +126,21 @@ async def scan_query(session, address, start, end, step, timeout):
         return None
 
 
-async def scan_database(address, days, step, limit, timeout):
+async def scan_database(address, ranges, step, limit, timeout):
     """
     Generate many asynchronous queries to identify jobs and their start/end
     times in a database.
 
     Args:
         address (str): Address of the Prometheus server.
-        days (int): Number of days to scan (range [now-days, now]).
+        ranges (list): List of (start, end) timestamps to scan, one query each.
         step (int): Query resolution in seconds.
         limit (int): Number of concurrent requests.
         timeout (float): Request timeout in seconds.
 
     Returns:
-        list: list of scan results.
+        list: list of scan results, in the same order as ranges.
     """
-    scan_start = time.time() - (days * 24 * 60 * 60)
-    ranges = []
-
-    for i in range(days):
-        day_start = scan_start + i * 24 * 60 * 60
-        day_end = day_start + 24 * 60 * 60
-        ranges.append((int(day_start), int(day_end)))
-
     connector = aiohttp.TCPConnector(limit=limit)
     async with aiohttp.ClientSession(connector=connector) as session:
         tasks = []
@@ -148,58 +151,155 @@ async def scan_database(address, days, step, limit, timeout):
         return results
 
 
+def scan_shards(scan_start, scan_end, shard_hours):
+    """Split [scan_start, scan_end] into consecutive time shards"""
+    shard_secs = shard_hours * SECONDS_PER_HOUR
+    ranges = []
+    start = scan_start
+    while start < scan_end:
+        end = min(start + shard_secs, scan_end)
+        ranges.append((int(start), int(end)))
+        start = end
+    return ranges
+
+
+def load_index(index_file, step):
+    """
+    Read a persisted job index. Returns an empty index if the file doesn't
+    exist or was generated with a different version or query resolution.
+    """
+    empty = {"version": INDEX_VERSION, "step": step, "scanned_until": None, "jobs": {}}
+    if not index_file or not os.path.isfile(index_file):
+        return empty
+    try:
+        with open(index_file, "r") as f:
+            index = json.load(f)
+    except (OSError, ValueError) as e:
+        print(f"Warning: ignoring unreadable index {index_file}: {e}")
+        return empty
+    if index.get("version") != INDEX_VERSION or index.get("step") != step:
+        print(f"Warning: ignoring index {index_file} generated with different settings")
+        return empty
+    return index
+
+
+def save_index(index_file, index):
+    """Atomically replace the persisted job index"""
+    if not index_file:
+        return
+    tmp_file = f"{index_file}.tmp"
+    try:
+        with open(tmp_file, "w") as f:
+            json.dump(index, f)
+        os.replace(tmp_file, index_file)
+    except OSError as e:
+        print(f"Warning: unable to save index {index_file}: {e}")
+
+
+def update_index(index, args):
+    """
+    Scan the range that is not yet covered by the index (the last args.days
+    days for a new index) and merge the results.
+
+    Returns:
+        tuple: number of queries and number of failed queries.
+    """
+    now = time.time()
+    if index["scanned_until"] is None:
+        scan_start = now - (args.days * 24 * SECONDS_PER_HOUR)
+    else:
+        scan_start = index["scanned_until"] - (args.overlap * SECONDS_PER_HOUR)
+    ranges = scan_shards(scan_start, now, args.shard_hours)
+
+    results = asyncio.run(scan_database(args.address, ranges, args.step, args.limit, args.timeout))
+
+    # The index only advances up to the first failed shard, so that failed
+    # ranges are scanned again in the next update. Results from later shards
+    # are discarded: a job that was also running in the failed shard would
+    # otherwise be indexed with a start time that is too late.
+    scanned = results.index(None) if None in results else len(ranges)
+    scanned_until = ranges[scanned][0] if scanned < len(ranges) else now
+    index["scanned_until"] = max(scanned_until, index["scanned_until"] or 0)
+
+    # Flatten results from different requests, which may contain information
+    # about multiple jobs, and index them by job ID.
+    jobs = index["jobs"]
+    for job_id, first, last, num_nodes in [x for result in results[:scanned] for x in result]:
+        if job_id in jobs:
+            first = min(first, jobs[job_id]["start"])
+            last = max(last, jobs[job_id]["end"])
+            num_nodes = max(num_nodes, jobs[job_id]["num_nodes"], key=float)
+        jobs[job_id] = {"start": first, "end": last, "num_nodes": num_nodes}
+
+    return len(ranges), results.count(None)
+
+
+def job_data(index):
+    """
+    Tranform data to be used in Grafana; timestamps are expected to be
+    milliseconds. Lowercase keys are hidden from the table and only used
+    internally.
+    """
+    step = index["step"]
+    data = []
+    for job_id, job in index["jobs"].items():
+        data.append(
+            {
+                "Job ID": job_id,
+                "Number of nodes": job["num_nodes"],
+                "Date": job["start"] * 1000,
+                "Duration": job["end"] - job["start"],
+                "from": (job["start"] - step) * 1000,
+                "to": (job["end"] + step) * 1000,
+            }
+        )
+    return data
+
+
+def refresh_index(index, handler, args):
+    """Periodically update the index and the data served by the handler"""
+    while True:
+        time.sleep(args.refresh)
+        num_queries, num_fail = update_index(index, args)
+        save_index(args.index_file, index)
+        handler.data = job_data(index)
+        if num_fail > 0:
+            print(f".. Warning: {num_fail} out of {num_queries} refresh queries failed")
+            sys.stdout.flush()
+
+
 parser = argparse.ArgumentParser()
 parser.add_argument("--address", type=str, default="localhost:9090")
 parser.add_argument("--days", type=int, default=365)
 parser.add_argument("--step", type=int, default=30)
 parser.add_argument("--limit", type=int, default=16)
 parser.add_argument("--timeout", type=float, default=5)
+parser.add_argument("--index-file", type=str, default=None, help="file to persist the job index")
+parser.add_argument("--shard-hours", type=float, default=24, help="time range covered by each scan query")
+parser.add_argument("--overlap", type=float, default=24, help="hours before the last scan to scan again")
+parser.add_argument("--refresh", type=float, default=0, help="secs between incremental updates (0 = disabled)")
 args = parser.parse_args()
 
+index = load_index(args.index_file, args.step)
+incremental = index["scanned_until"] is not None
+
 start_time = time.time()
-results = asyncio.run(scan_database(args.address, args.days, args.step, args.limit, args.timeout))
+num_queries, num_fail = update_index(index, args)
 end_time = time.time()
+save_index(args.index_file, index)
+
+data = job_data(index)
 
-num_queries = args.days
-num_fail = results.count(None)
-num_success = num_queries - num_fail
-
-# Flatten results from different requests, which may contain information
-# about multiple jobs.
-results = [x for result in results if result != None for x in result]
-
-# Index results by job ID, combining results from different requests.
-job_index = {}
-for job_id, first, last, num_nodes in results:
-    if job_id in job_index:
-        first = min(first, job_index[job_id][0])
-        last = max(last, job_index[job_id][1])
-        num_nodes = max(num_nodes, job_index[job_id][2])
-    job_index[job_id] = (first, last, num_nodes)
-
-# Tranform data to be used in Grafana; timestamps are expected to be
-# milliseconds. Lowercase keys are hidden from the table and only used
-# internally.
-job_data = []
-for job_id, (start, end, num_nodes) in job_index.items():
-    job_data.append(
-        {
-            "Job ID": job_id,
-            "Number of nodes": num_nodes,
-            "Date": start * 1000,
-            "Duration": end - start,
-            "from": (start - args.step) * 1000,
-            "to": (end + args.step) * 1000,
-        }
-    )
-
-print(f"Scanned database in {end_time - start_time:.2f} seconds")
-print(f".. Number of jobs in the last {args.days} days: {len(job_data)}")
+mode = "Updated index" if incremental else "Scanned database"
+print(f"{mode} in {end_time - start_time:.2f} seconds ({num_queries} queries)")
+print(f".. Number of indexed jobs: {len(data)}")
 if num_fail > 0:
     print(f".. Warning: {num_fail} out of {num_queries} queries failed")
 sys.stdout.flush()
 
 server_address = ("", 9091)
-handler = JobIndexHandler(job_data)
+handler = JobIndexHandler(data)
+if args.refresh > 0:
+    threading.Thread(target=refresh_index, args=(index, handler, args), daemon=True).start()
 httpd = http.server.HTTPServer(server_address, handler)
 httpd.serve_forever()
@@ -41,6 +41,9 @@ SOURCE_ADDRESS=localhost:8428
 # Path to the temporary file used for exporting/importing databases.
 DATA_FILE=/tmp/data.bin
 
+# Persisted job index, updated incrementally every time the services start.
+INDEX_FILE=$TARGET_DIR/.omnistat-index.json
+
 # Default Victoria Metrics configuration.
 VICTORIA_BIN=/victoria-metrics-prod
 VICTORIA_RETENTION_PERIOD=${VICTORIA_RETENTION_PERIOD:-3y}
@@ -226,6 +229,11 @@ merge_databases() {
     elapsed_time=$((end_time - start_time))
     echo "Loaded $num_databases new databases in $elapsed_time seconds"
 
+    # Merged databases may contain jobs in ranges that were already indexed
+    if [ $num_databases -gt 0 ]; then
+        rm -f $INDEX_FILE
+    fi
+
     # Shutdown target Victoria Metrics
     kill -SIGINT $target_pid
     check_victoria_lock $TARGET_DIR
@@ -263,7 +271,8 @@ omnistat-index \
     --days ${INDEX_DAYS:-365} \
     --step ${INDEX_STEP:-30} \
     --limit ${INDEX_LIMIT:-16} \
-    --timeout ${INDEX_QUERY_TIMEOUT:-5} &
+    --timeout ${INDEX_QUERY_TIMEOUT:-5} \
+    --index-file ${INDEX_FILE} &
 index_pid=$!
 
 wait_for_url $INDEX_URL $INDEX_INTERVAL $INDEX_TIMEOUT
@@ -0,0 +1,101 @@
+/* -------------------------------------------------------------------------------
+ * MIT License
+ *
+ * Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * -------------------------------------------------------------------------------
+ */
+
+#include "omnistat_fom.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int fom_socket = -1;
+static struct sockaddr_un fom_address;
+static int64_t fom_dropped = 0;
+
+int omnistat_fom_init(void) {
+  const char *path = getenv("OMNISTAT_FOM_SOCKET");
+  char default_path[sizeof(fom_address.sun_path)];
+
+  if (fom_socket >= 0)
+    return 0;
+
+  if (path == NULL || path[0] == '\0') {
+    const char *user = getenv("USER");
+    if (user != NULL)
+      snprintf(default_path, sizeof(default_path), "/tmp/omnistat_%s_fom.sock", user);
+    else
+      snprintf(default_path, sizeof(default_path), "/tmp/omnistat_%u_fom.sock", (unsigned)getuid());
+    path = default_path;
+  }
+  if (strlen(path) >= sizeof(fom_address.sun_path))
+    return -1;
+
+  memset(&fom_address, 0, sizeof(fom_address));
+  fom_address.sun_family = AF_UNIX;
+  strcpy(fom_address.sun_path, path);
+
+  fom_socket = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  return fom_socket >= 0 ? 0 : -1;
+}
+
+int omnistat_fom_report_at(const char *name, double value, int64_t timestamp_msecs) {
+  char message[512];
+  int length;
+
+  if (fom_socket < 0 && omnistat_fom_init() != 0) {
+    fom_dropped++;
+    return -1;
+  }
+
+  length = snprintf(message, sizeof(message), "%s %.17g %lld", name, value, (long long)timestamp_msecs);
+  if (length < 0 || length >= (int)sizeof(message)) {
+    fom_dropped++;
+    return -1;
+  }
+  if (sendto(fom_socket, message, length, MSG_DONTWAIT, (struct sockaddr *)&fom_address, sizeof(fom_address)) < 0) {
+    fom_dropped++;
+    return -1;
+  }
+  return 0;
+}
+
+int omnistat_fom_report(const char *name, double value) {
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return omnistat_fom_report_at(name, value, (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000);
+}
+
+int64_t omnistat_fom_dropped(void) { return fom_dropped; }
+
+void omnistat_fom_finalize(void) {
+  if (fom_socket >= 0) {
+    close(fom_socket);
+    fom_socket = -1;
+  }
+}
@@ -0,0 +1,57 @@
+! -------------------------------------------------------------------------------
+! MIT License
+!
+! Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+!
+! Permission is hereby granted, free of charge, to any person obtaining a copy
+! of this software and associated documentation files (the "Software"), to deal
+! in the Software without restriction, including without limitation the rights
+! to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+! copies of the Software, and to permit persons to whom the Software is
+! furnished to do so, subject to the following conditions:
+!
+! The above copyright notice and this permission notice shall be included in all
+! copies or substantial portions of the Software.
+!
+! THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+! IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+! FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+! AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+! LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+! OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+! SOFTWARE.
+! -------------------------------------------------------------------------------
+
+! Fortran interface to the Omnistat FOM client (omnistat_fom.c)
+!
+!   use omnistat_fom
+!   ierr = omnistat_fom_report("iterations_per_sec", rate)
+
+module omnistat_fom
+  use iso_c_binding
+  implicit none
+
+  interface
+     integer(c_int) function omnistat_fom_init() bind(C, name="omnistat_fom_init")
+       import :: c_int
+     end function omnistat_fom_init
+
+     integer(c_int) function omnistat_fom_report_c(name, value) bind(C, name="omnistat_fom_report")
+       import :: c_int, c_char, c_double
+       character(kind=c_char), dimension(*), intent(in) :: name
+       real(c_double), value :: value
+     end function omnistat_fom_report_c
+
+     subroutine omnistat_fom_finalize() bind(C, name="omnistat_fom_finalize")
+     end subroutine omnistat_fom_finalize
+  end interface
+
+contains
+
+  integer function omnistat_fom_report(name, value)
+    character(len=*), intent(in) :: name
+    real(c_double), intent(in) :: value
+    omnistat_fom_report = omnistat_fom_report_c(trim(name)//c_null_char, value)
+  end function omnistat_fom_report
+
+end module omnistat_fom
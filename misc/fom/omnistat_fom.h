@@ -0,0 +1,61 @@
+/* -------------------------------------------------------------------------------
+ * MIT License
+ *
+ * Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * -------------------------------------------------------------------------------
+ */
+
+/*
+ * Client for reporting application figures of merit (FOM) to the local
+ * user-mode Omnistat exporter (enable_fom_socket = True). Samples are sent as
+ * non-blocking datagrams to the Unix socket named by OMNISTAT_FOM_SOCKET
+ * (default: /tmp/omnistat_${USER}_fom.sock); samples are dropped rather than
+ * blocking the caller when the exporter is unavailable.
+ */
+
+#ifndef OMNISTAT_FOM_H
+#define OMNISTAT_FOM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Open the exporter socket; returns 0 on success */
+int omnistat_fom_init(void);
+
+/* Report a FOM sample stamped with the current time; returns 0 if sent */
+int omnistat_fom_report(const char *name, double value);
+
+/* Report a FOM sample with an explicit timestamp (msecs since epoch); returns 0 if sent */
+int omnistat_fom_report_at(const char *name, double value, int64_t timestamp_msecs);
+
+/* Number of samples dropped so far */
+int64_t omnistat_fom_dropped(void);
+
+void omnistat_fom_finalize(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,153 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+
+"""Direct amd-smi library reads for all GPUs into a preallocated array
+
+The amdsmi Python interface returns a freshly allocated dict (with values
+converted in Python) for every query. For per-sample collection, this module
+instead calls the underlying C library entry points exposed by the ctypes
+bindings in amdsmi.amdsmi_wrapper, reusing one output structure per query
+type, and stores results in a single contiguous array of doubles with a fixed
+(gpu, column) layout:
+
+    values[gpu * width + column]
+
+Values that could not be read (failed queries or fields flagged as
+unsupported by the GPU metrics table) are stored as NaN so callers can retain
+their previous value.
+"""
+
+import ctypes
+import math
+from array import array
+
+from amdsmi import amdsmi_wrapper
+
+
+def unsupported(structure, field):
+    """Sentinel used by the library for unsupported unsigned integer fields (all bits set)"""
+    return (1 << (8 * getattr(structure, field).size)) - 1
+
+
+class AMDSMISweep:
+    def __init__(self, handles):
+        self.__handles = list(handles)
+        self.__calls = {}
+        self.__columns = []
+        self.__plans = {}
+        self.values = array("d")
+
+    @property
+    def width(self):
+        """Number of columns per GPU"""
+        return len(self.__columns)
+
+    @property
+    def columns(self):
+        return list(self.__columns)
+
+    def add(self, name, function, args, outType, field=None, scale=1.0, checkSupported=False):
+        """Register a column read from out (or out.field) after function(handle, *args, byref(out))
+
+        Queries with the same function and arguments are issued once per device, regardless of
+        the number of columns they provide.
+
+        Returns:
+            int: column index
+        """
+        key = (function, args)
+        call = self.__calls.get(key)
+        if call is None:
+            # raises AttributeError if not provided by local library bindings
+            entry = getattr(amdsmi_wrapper, function)
+            out = outType()
+            call = (entry, args, out, ctypes.byref(out), [])
+            self.__calls[key] = call
+        if field is not None and not hasattr(outType, field):
+            raise AttributeError("%s has no field %s" % (outType.__name__, field))
+        if field is not None and hasattr(getattr(call[2], field), "_length_"):
+            raise TypeError("%s.%s is not a scalar field" % (outType.__name__, field))
+
+        sentinel = unsupported(outType, field) if checkSupported else None
+        column = len(self.__columns)
+        self.__columns.append(name)
+        call[4].append((column, field, scale, sentinel))
+        self.values = array("d", [math.nan]) * (len(self.__handles) * self.width)
+        self.__plans.clear()
+        return column
+
+    def addTableField(self, name, field):
+        """Column from the GPU metrics table (amdsmi_get_gpu_metrics_info)"""
+        return self.add(
+            name, "amdsmi_get_gpu_metrics_info", (), amdsmi_wrapper.amdsmi_gpu_metrics_t, field, checkSupported=True
+        )
+
+    def addTemperature(self, name, sensor, metric):
+        return self.add(name, "amdsmi_get_temp_metric", (int(sensor), int(metric)), ctypes.c_int64)
+
+    def addMemory(self, name, function, memoryType):
+        return self.add(name, function, (int(memoryType),), ctypes.c_uint64)
+
+    def addEccCount(self, name, block, field):
+        return self.add(name, "amdsmi_get_gpu_ecc_count", (int(block),), amdsmi_wrapper.amdsmi_error_count_t, field)
+
+    def addPowerCap(self, name, scale):
+        return self.add(
+            name, "amdsmi_get_power_cap_info", (0,), amdsmi_wrapper.amdsmi_power_cap_info_t, "power_cap", scale
+        )
+
+    def plan(self, columns):
+        """Queries needed to read a subset of columns (cached per subset)"""
+        plan = self.__plans.get(columns)
+        if plan is None:
+            plan = []
+            for entry, args, out, ref, entries in self.__calls.values():
+                selected = [e for e in entries if columns is None or e[0] in columns]
+                if selected:
+                    plan.append((entry, args, out, ref, selected))
+            self.__plans[columns] = plan
+        return plan
+
+    def sweep(self, columns=None):
+        """Read all (or the given frozenset of) columns for every GPU
+
+        Returns:
+            array: values indexed by gpu * width + column
+        """
+        values = self.values
+        width = len(self.__columns)
+        nan = math.nan
+        plan = self.plan(columns)
+        for gpu, handle in enumerate(self.__handles):
+            base = gpu * width
+            for entry, args, out, ref, entries in plan:
+                if entry(handle, *args, ref) != 0:
+                    for column, field, scale, sentinel in entries:
+                        values[base + column] = nan
+                    continue
+                for column, field, scale, sentinel in entries:
+                    value = out.value if field is None else getattr(out, field)
+                    values[base + column] = nan if value == sentinel else value * scale
+        return values
@@ -47,7 +47,9 @@ class omnistat_annotate:
     def start(self, label):
         data = {}
         data["annotation"] = label
-        data["timestamp_secs"] = int(time.time())
+        now = time.time()
+        data["timestamp_secs"] = int(now)
+        data["timestamp_msecs"] = int(now * 1000)
 
         with open(self.filename, "w") as outfile:
             outfile.write(json.dumps(data, indent=4))
@@ -0,0 +1,240 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+
+"""High-rate burst sampling of a small set of GPU metrics
+
+A background thread samples the burst sources provided by collectors (e.g.
+GPU power, utilization, and clocks read from the SMI metrics table) at a
+high rate into a fixed-size ring buffer that always holds the most recent
+history. Samples are discarded as they age out of the ring unless a burst
+window has been requested, either through a user annotation (see
+omnistat-annotate) or explicitly via begin()/end(). Requested windows are
+extended by burst_window_secs before the start and after the end of the
+region so the transitions are captured, and are delivered at full
+resolution via drain() alongside regular samples.
+
+Rows within a requested region are moved out of the ring by the sampler
+thread as soon as they are recorded, so they are retained regardless of how
+long the consumer takes to call drain() (e.g. while blocked on a slow push).
+Only the history preceding a region is read from the ring; rows of that
+window that were already overwritten are counted as lost.
+"""
+
+import json
+import logging
+import math
+import os
+import threading
+import time
+from array import array
+
+from omnistat.file_watcher import FileWatcher
+from omnistat.scheduler import DeadlineScheduler
+
+
+class BurstSampler:
+    def __init__(self, sources, interval_secs, window_secs, capacity_secs, annotationFile=None):
+        """
+        Args:
+            sources (list): (series, sample) pairs provided by Collector.burstMetrics()
+            interval_secs (float): burst sampling interval
+            window_secs (float): history captured before (and after) a requested region
+            capacity_secs (float): ring buffer length; must cover the window
+            annotationFile (str): optional annotation file starting/stopping burst regions
+        """
+        self.__series = []
+        self.__samplers = []
+        for series, sample in sources:
+            self.__series.extend(series)
+            self.__samplers.append(sample)
+        self.__width = len(self.__series)
+        self.__interval = interval_secs
+        self.__windowNs = int(window_secs * 1e9)
+        self.__capacity = int(max(capacity_secs, window_secs) / interval_secs) + 1
+        self.__timestamps = array("q", bytes(8 * self.__capacity))
+        self.__values = array("d", bytes(8 * self.__capacity * self.__width))
+        self.__head = 0
+        self.__pending = []
+        self.__lastCaptured = None
+        self.__captureStart = None
+        self.__captureEnd = None
+        self.__regions = 0
+        self.__lost = 0
+        self.__lock = threading.Lock()
+        self.__stopping = False
+        self.__thread = None
+
+        self.__annotationFile = annotationFile
+        self.__annotationMtime = None
+        self.__watcher = None
+        if annotationFile:
+            self.__watcher = FileWatcher([annotationFile])
+
+    @property
+    def series(self):
+        """(metric name, labels) for each sampled value"""
+        return self.__series
+
+    @property
+    def regions(self):
+        """Number of burst regions requested"""
+        return self.__regions
+
+    @property
+    def lost(self):
+        """Number of rows within requested regions that were overwritten before being captured"""
+        return self.__lost
+
+    @property
+    def active(self):
+        return self.__captureStart is not None
+
+    def begin(self, timestamp_ns=None):
+        """Start a burst region (including the preceding window of history)"""
+        if timestamp_ns is None:
+            timestamp_ns = time.time_ns()
+        with self.__lock:
+            if self.__captureStart is None:
+                self.__captureStart = timestamp_ns - self.__windowNs
+                self.__regions += 1
+                self.captureHistory()
+                logging.info("Burst sampling region started")
+            self.__captureEnd = None
+
+    def captureHistory(self):
+        """Move rows of the ring within the current region to the pending rows (with lock held)"""
+        start = self.__captureStart
+        if self.__lastCaptured is not None:
+            start = max(start, self.__lastCaptured + 1)
+        first = max(0, self.__head - self.__capacity)
+        for index in range(first, self.__head):
+            slot = index % self.__capacity
+            if self.__timestamps[slot] >= start:
+                self.captureRow(slot)
+
+        # history older than the ring was overwritten
+        if self.__head > 0:
+            oldest = self.__timestamps[first % self.__capacity]
+            if oldest > start:
+                lost = int((oldest - start) / (self.__interval * 1e9))
+                if lost > 0 and self.__head > self.__capacity:
+                    self.__lost += lost
+                    logging.warning("[WARN]: Burst sampling lost %i row(s) preceding the requested region" % lost)
+
+    def captureRow(self, slot):
+        """Copy a row of the ring to the pending rows (with lock held)"""
+        timestamp = self.__timestamps[slot]
+        self.__pending.append((timestamp, self.__values[slot * self.__width : (slot + 1) * self.__width]))
+        self.__lastCaptured = timestamp
+
+    def end(self, timestamp_ns=None):
+        """End the current burst region after a trailing window"""
+        if timestamp_ns is None:
+            timestamp_ns = time.time_ns()
+        with self.__lock:
+            if self.__captureStart is not None and self.__captureEnd is None:
+                self.__captureEnd = timestamp_ns + self.__windowNs
+                logging.info("Burst sampling region stopped")
+
+    def start(self):
+        self.__thread = threading.Thread(target=self.run, name="omnistat-burst", daemon=True)
+        self.__thread.start()
+
+    def stop(self):
+        self.__stopping = True
+        if self.__thread is not None:
+            self.__thread.join()
+        if self.__watcher is not None:
+            self.__watcher.close()
+
+    def run(self):
+        """Sampler thread: record one row of values per burst interval"""
+        scheduler = DeadlineScheduler(self.__interval)
+        deadline_ns = scheduler.start()
+        width = self.__width
+        values = self.__values
+        while not self.__stopping:
+            row = []
+            for sample in self.__samplers:
+                row.extend(sample())
+            with self.__lock:
+                slot = self.__head % self.__capacity
+                self.__timestamps[slot] = deadline_ns
+                values[slot * width : (slot + 1) * width] = array("d", row)
+                self.__head += 1
+                if self.__captureStart is not None:
+                    if self.__captureEnd is None or deadline_ns <= self.__captureEnd:
+                        self.captureRow(slot)
+                    if self.__captureEnd is not None and deadline_ns >= self.__captureEnd:
+                        self.__captureStart = None
+                        self.__captureEnd = None
+            if self.__annotationFile:
+                self.checkAnnotation()
+            scheduler.wait()
+            deadline_ns = scheduler.deadline_ns
+
+    def checkAnnotation(self):
+        """Start/stop burst regions when an annotation is written/removed"""
+        if self.__watcher.enabled and not self.__watcher.changed(self.__annotationFile):
+            return
+        try:
+            mtime = os.stat(self.__annotationFile).st_mtime_ns
+        except FileNotFoundError:
+            mtime = None
+        if mtime == self.__annotationMtime:
+            return
+        self.__annotationMtime = mtime
+
+        if mtime is None:
+            self.end()
+            return
+        timestamp_ns = None
+        try:
+            with open(self.__annotationFile) as f:
+                data = json.load(f)
+            if "timestamp_msecs" in data:
+                timestamp_ns = int(data["timestamp_msecs"]) * 1000000
+        except (OSError, ValueError):
+            pass
+        self.begin(timestamp_ns)
+
+    def drain(self, emit):
+        """Deliver buffered samples within requested burst regions via emit(column, timestamp_msecs, value)
+
+        Returns:
+            int: number of samples delivered
+        """
+        with self.__lock:
+            rows = self.__pending
+            self.__pending = []
+
+        count = 0
+        for timestamp, row in rows:
+            timestamp_msecs = timestamp // 1000000
+            for column, value in enumerate(row):
+                if not math.isnan(value):
+                    emit(column, timestamp_msecs, value)
+                    count += 1
+        return count
@@ -26,6 +26,9 @@
 #
 # Base Collector class - defines required methods for all metric collectors
 # implemented as a child class.
+#
+# SamplingTiers class - optional helper for collectors that refresh slowly
+# changing metrics at a reduced rate.
 # --
 
 from abc import ABC, abstractmethod
@@ -42,3 +45,43 @@ class Collector(ABC):
     def updateMetrics(self):
         """Updates defined metrics with latest values. Called at every polling interval."""
         pass
+
+    # Optional methods
+    def burstMetrics(self):
+        """Provides a source for high-rate burst sampling (user-mode only). Returns None or a tuple
+        (series, sample) where series lists (metric name, labels) pairs of registered metrics and
+        sample() returns their current values in the same order (NaN if unavailable). sample() is
+        called from a separate thread and must not update registered metrics."""
+        return None
+
+
+class SamplingTiers:
+    """Assigns metrics to sampling tiers refreshed every N collector updates (ticks).
+
+    Tier periods and per-metric tier overrides are provided via the runtime config. Metrics
+    skipped on a given tick retain (and continue to serve) their last value.
+    """
+
+    tiers = ("fast", "normal", "slow")
+
+    def __init__(self, periods, overrides=None):
+        self.__periods = periods
+        self.__overrides = overrides or {}
+        self.__assigned = {}
+        self.__tick = -1
+        self.__dueTiers = set(self.tiers)
+
+    def assign(self, metric, tier):
+        """Assign metric to a default tier (unless overridden in runtime config) and return active tier"""
+        tier = self.__overrides.get(metric, tier)
+        self.__assigned[metric] = tier
+        return tier
+
+    def tick(self):
+        """Advance to next collector update; must be called once at the start of each update"""
+        self.__tick += 1
+        self.__dueTiers = {tier for tier, period in self.__periods.items() if self.__tick % period == 0}
+
+    def due(self, metric):
+        """Check if metric should be refreshed during the current update"""
+        return self.__assigned.get(metric, "normal") in self.__dueTiers
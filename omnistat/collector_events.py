@@ -22,10 +22,11 @@
 # SOFTWARE.
 # -------------------------------------------------------------------------------
 
-import _thread
+import atexit
 import logging
 import os
 import sys
+import threading
 import time
 
 from amdsmi import *
@@ -36,11 +37,27 @@ from omnistat.collector_base import Collector
 
 
 class ROCMEvents(Collector):
-    def __init__(self):
+    def __init__(self, runtimeConfig=None):
         logging.debug("Initializing ROCm SMI event collector")
         self.__prefix = "rocm_"
         self.__events = []
-        self.__desiredEventTypes = [AmdSmiEvtNotificationType.THERMAL_THROTTLE]
+        self.__handleToGpu = {}
+        self.__timeoutMsecs = 1000
+        self.__batchSize = 64
+
+        eventTypes = ["THERMAL_THROTTLE"]
+        if runtimeConfig is not None:
+            eventTypes = runtimeConfig.get("collector_event_types", eventTypes)
+        self.__desiredEventTypes = []
+        for name in eventTypes:
+            try:
+                self.__desiredEventTypes.append(AmdSmiEvtNotificationType[name])
+            except KeyError:
+                logging.error("")
+                logging.error("[ERROR]: Unknown SMI event type requested (%s)" % name)
+                logging.error("--> supported types: %s" % [e.name for e in AmdSmiEvtNotificationType])
+                sys.exit(1)
+        self.__typeNames = [e.name for e in self.__desiredEventTypes]
 
         try:
             amdsmi_init()
@@ -54,27 +71,29 @@ class ROCMEvents(Collector):
                 sys.exit(1)
             else:
                 self.__numGpus = len(devices)
-                for device in devices:
+                for gpu, device in enumerate(devices):
                     self.__events.append(AmdSmiEventReader(device, self.__desiredEventTypes))
+                    self.__handleToGpu[self.handleKey(device)] = gpu
         except AmdSmiException as e:
             logging.error("unable to get processor handles")
             logging.error(e)
             sys.exit(1)
 
-        # Launch polling threads for event reads (1 per GPU) - polling at 0.1 sec interval
-        try:
-            for i in range(self.__numGpus):
-                _thread.start_new_thread(self.poll_gpu_events, (self.__events[i], i, 100))
-            time.sleep(0.25)
+        # Event counts and latest event timestamps indexed by [gpu][event type]; shared with reader thread
+        self.__lock = threading.Lock()
+        self.__counts = [dict.fromkeys(self.__typeNames, 0) for gpu in range(self.__numGpus)]
+        self.__timestamps = [dict.fromkeys(self.__typeNames, None) for gpu in range(self.__numGpus)]
 
-        except Exception as e:
-            logging.error("Error: Unable to start new thread. %s" % (e))
-            sys.exit(1)
+        # Launch single reader thread: event notifications for all initialized
+        # GPUs are delivered through one multiplexed wait on the KFD event fds
+        self.__shutdown = threading.Event()
+        self.__thread = threading.Thread(target=self.readEvents, name="omnistat-events", daemon=True)
+        self.__thread.start()
+        atexit.register(self.stop)
 
-        logging.info("SMI event collector initialized")
+        logging.info("SMI event collector initialized (event types = %s)" % self.__typeNames)
 
         self.__GPUmetrics = {}
-        self.__throttle_count = []
 
     # --------------------------------------------------------------------------------------
     # Required child methods
@@ -84,24 +103,85 @@ class ROCMEvents(Collector):
         metricName = self.__prefix + "throttle_events"
         self.__GPUmetrics["throttle_events"] = Gauge(metricName, "# of throttling events detected", labelnames=["card"])
         logging.info("--> [registered] %s (gauge)" % metricName)
+
+        metricName = self.__prefix + "gpu_events"
+        self.__GPUmetrics["gpu_events"] = Gauge(metricName, "# of SMI events detected", labelnames=["card", "type"])
+        logging.info("--> [registered] %s (gauge)" % metricName)
+
+        metricName = self.__prefix + "gpu_last_event_timestamp_seconds"
+        self.__GPUmetrics["gpu_last_event_timestamp"] = Gauge(
+            metricName, "Time of most recent SMI event (seconds since epoch)", labelnames=["card", "type"]
+        )
+        logging.info("--> [registered] %s (gauge)" % metricName)
+
         for gpu in range(self.__numGpus):
             self.__GPUmetrics["throttle_events"].labels(card=gpu).set(0)
-            self.__throttle_count.append(0)
+            for name in self.__typeNames:
+                self.__GPUmetrics["gpu_events"].labels(card=gpu, type=name).set(0)
         return
 
     def updateMetrics(self):
+        with self.__lock:
+            counts = [dict(entry) for entry in self.__counts]
+            timestamps = [dict(entry) for entry in self.__timestamps]
+
         for gpu in range(self.__numGpus):
-            self.__GPUmetrics["throttle_events"].labels(card=gpu).set(self.__throttle_count[gpu])
+            self.__GPUmetrics["throttle_events"].labels(card=gpu).set(counts[gpu].get("THERMAL_THROTTLE", 0))
+            for name in self.__typeNames:
+                self.__GPUmetrics["gpu_events"].labels(card=gpu, type=name).set(counts[gpu][name])
+                if timestamps[gpu][name] is not None:
+                    self.__GPUmetrics["gpu_last_event_timestamp"].labels(card=gpu, type=name).set(timestamps[gpu][name])
         return
 
     # --------------------------------------------------------------------------------------
     # Additional custom methods unique to this collector
 
-    def poll_gpu_events(self, event, gpu_index, timeout_msec):
-        while 1:
+    @staticmethod
+    def handleKey(handle):
+        """Convert processor handle (ctypes pointer or address) into a hashable key"""
+        return getattr(handle, "value", handle)
+
+    def readEvents(self):
+        """Reader thread: wait for events from all GPUs and accumulate per-GPU counts"""
+        reader = self.__events[0]
+        failing = False
+        while not self.__shutdown.is_set():
+            start = time.monotonic()
+            try:
+                newevents = reader.read(self.__timeoutMsecs, self.__batchSize)
+                now = time.time()
+                with self.__lock:
+                    for event in newevents:
+                        gpu = self.__handleToGpu.get(self.handleKey(event["processor_handle"]))
+                        name = event["event"]
+                        if gpu is None or name not in self.__counts[gpu]:
+                            continue
+                        self.__counts[gpu][name] += 1
+                        self.__timestamps[gpu][name] = now
+            except AmdSmiException:
+                # no events within timeout; avoid spinning if the wait returned early
+                if time.monotonic() - start < self.__timeoutMsecs / 2000:
+                    self.__shutdown.wait(self.__timeoutMsecs / 1000)
+                continue
+            except Exception as e:
+                # unexpected read or decode failure: keep the reader alive and back off before retrying
+                if not failing:
+                    logging.warning("[WARN]: collector_events: failed to read events, retrying (%s)" % e)
+                    failing = True
+                self.__shutdown.wait(max(1.0, self.__timeoutMsecs / 1000))
+                continue
+            failing = False
+        return
+
+    def stop(self):
+        """Stop reader thread and event notifications"""
+        if self.__shutdown.is_set():
+            return
+        self.__shutdown.set()
+        self.__thread.join(2 * self.__timeoutMsecs / 1000)
+        for event in self.__events:
             try:
-                newevents = event.read(timeout_msec)
-                self.__throttle_count[gpu_index] += len(newevents)
-            except:
+                event.stop()
+            except AmdSmiException:
                 pass
         return
@@ -34,20 +34,39 @@ import os
 import platform
 import re
 import sys
+import time
 from pathlib import Path
 
 from prometheus_client import Gauge
 
 import omnistat.utils as utils
 from omnistat.collector_base import Collector
+from omnistat.sysfs_reader import SysfsReader
 
 
 class NETWORK(Collector):
-    def __init__(self, annotations=False, jobDetection=None):
+    def __init__(self, annotations=False, jobDetection=None, runtimeConfig=None):
         logging.debug("Initializing network data collector")
 
         self.__prefix = "omnistat_network_"
 
+        # Optional bandwidth rates derived from successive counter samples,
+        # tracked per metric and interface as (value, monotonic time).
+        self.__rates_enabled = runtimeConfig is not None and runtimeConfig.get("collector_network_rates", False)
+        self.__rate_state = {}
+        self.__sampleTime = None
+        self.__rx_metric = None
+        self.__tx_metric = None
+        self.__rx_rate_metric = None
+        self.__tx_rate_metric = None
+
+        # Width of /sys/class/net statistics (unsigned long in the kernel).
+        self.__net_counter_bits = 64 if sys.maxsize > 2**32 else 32
+
+        # Statistics files are opened once and re-read on every update; the
+        # data path dictionaries below store reader handles.
+        self.__reader = SysfsReader()
+
         # Files to check for IP devices.
         self.__net_rx_data_paths = {}
         self.__net_tx_data_paths = {}
@@ -63,11 +82,11 @@ class NETWORK(Collector):
     def registerMetrics(self):
         """Register metrics of interest"""
 
-        # Standard IP (/sys/class/net): store data paths to sysfs
-        # statistics files for local NICs, indexed by interface ID. For
-        # example, for Rx bandwidth:
+        # Standard IP (/sys/class/net): store handles to sysfs statistics
+        # files for local NICs, indexed by interface ID. For example, for Rx
+        # bandwidth:
         #   __net_rx_data_paths = {
-        #       "eth0": "/sys/class/net/eth0/statistics/rx_bytes"
+        #       "eth0": <handle for /sys/class/net/eth0/statistics/rx_bytes>
         #   }
         for nic in Path("/sys/class/net").iterdir():
             if not nic.is_dir():
@@ -79,15 +98,15 @@ class NETWORK(Collector):
 
             rx_path = nic / "statistics/rx_bytes"
             if rx_path.is_file() and rx_path.stat().st_size > 0:
-                self.__net_rx_data_paths[nic_name] = rx_path
+                self.addDataPath(self.__net_rx_data_paths, nic_name, rx_path)
 
             tx_path = nic / "statistics/tx_bytes"
             if tx_path.is_file() and tx_path.stat().st_size > 0:
-                self.__net_tx_data_paths[nic_name] = tx_path
+                self.addDataPath(self.__net_tx_data_paths, nic_name, tx_path)
 
-        # Slingshot CXI traffic (/sys/class/cxi): store data paths to binned
+        # Slingshot CXI traffic (/sys/class/cxi): store handles to binned
         # telemetry files, indexed by interface ID and minimum size of the
-        # bucket. For example, for Rx bandwidth:
+        # bucket. For example, for Rx bandwidth (paths shown for handles):
         #   __cxi_rx_data_paths = {
         #       "cxi0": {
         #           27: "/sys/class/cxi/cx0/device/telemetry/hni_rx_ok_27",
@@ -125,11 +144,11 @@ class NETWORK(Collector):
 
                 kind = match.group(1)
                 min_size = int(match.group(2))
-                cxi_data_paths[kind][nic_name][min_size] = bucket
+                self.addDataPath(cxi_data_paths[kind][nic_name], min_size, bucket)
 
-        # Infiniband traffic (/sys/class/infiniband): store data paths to
+        # Infiniband traffic (/sys/class/infiniband): store handles to
         # counters, indexed by interface ID and port ID. For example, for Rx
-        # bandwidth:
+        # bandwidth (paths shown for handles):
         #   __infiniband_rx_data_paths = {
         #       "mlx5_0:1": "/sys/class/infiniband/mlx5_0/ports/1/counters/port_rcv_data",
         #       "mlx5_1:1": "/sys/class/infiniband/mlx5_1/ports/1/counters/port_rcv_data",
@@ -151,11 +170,11 @@ class NETWORK(Collector):
 
                 rx_path = port / "counters" / "port_rcv_data"
                 if rx_path.is_file() and rx_path.stat().st_size > 0:
-                    self.__ib_rx_data_paths[nic_name] = rx_path
+                    self.addDataPath(self.__ib_rx_data_paths, nic_name, rx_path)
 
                 tx_path = port / "counters" / "port_xmit_data"
                 if tx_path.is_file() and tx_path.stat().st_size > 0:
-                    self.__ib_tx_data_paths[nic_name] = tx_path
+                    self.addDataPath(self.__ib_tx_data_paths, nic_name, tx_path)
 
         # Register Prometheus metrics for Rx and Tx. Devices are identified by
         # device class and interface name. For example, the Prometheus metric
@@ -171,6 +190,11 @@ class NETWORK(Collector):
             description = "Network received (bytes)"
             self.__rx_metric = Gauge(metric, description, labelnames=labels)
             logging.info(f"--> [registered] {metric} -> {description} (gauge)")
+            if self.__rates_enabled:
+                metric = self.__prefix + "rx_bytes_per_second"
+                description = "Network receive rate (bytes/sec)"
+                self.__rx_rate_metric = Gauge(metric, description, labelnames=labels)
+                logging.info(f"--> [registered] {metric} -> {description} (gauge)")
 
         tx_data_paths = [self.__net_tx_data_paths, self.__cxi_tx_data_paths, self.__ib_tx_data_paths]
         num_tx = sum([len(x) for x in tx_data_paths])
@@ -180,60 +204,109 @@ class NETWORK(Collector):
             description = "Network transmitted (bytes)"
             self.__tx_metric = Gauge(metric, description, labelnames=labels)
             logging.info(f"--> [registered] {metric} -> {description} (gauge)")
+            if self.__rates_enabled:
+                metric = self.__prefix + "tx_bytes_per_second"
+                description = "Network transmit rate (bytes/sec)"
+                self.__tx_rate_metric = Gauge(metric, description, labelnames=labels)
+                logging.info(f"--> [registered] {metric} -> {description} (gauge)")
+
+        logging.info(f"--> network: {len(self.__reader)} sysfs files opened for sampling")
+
+    def addDataPath(self, data_paths, key, path):
+        """Open sysfs file for repeated reads and store its handle under the given key"""
+        handle = self.__reader.open(path)
+        if handle is not None:
+            data_paths[key] = handle
 
     def updateMetrics(self):
         """Update registered metrics of interest"""
 
+        reader = self.__reader
+        self.__sampleTime = time.monotonic()
+
         net_data = [
-            (self.__net_rx_data_paths, self.__rx_metric),
-            (self.__net_tx_data_paths, self.__tx_metric),
+            (self.__net_rx_data_paths, self.__rx_metric, self.__rx_rate_metric),
+            (self.__net_tx_data_paths, self.__tx_metric, self.__tx_rate_metric),
         ]
 
-        for data_paths, metric in net_data:
-            for nic, path in data_paths.items():
+        for data_paths, metric, rate_metric in net_data:
+            for nic, handle in data_paths.items():
                 try:
-                    with open(path, "r") as f:
-                        data = int(f.read().strip())
-                        metric.labels(device_class="net", interface=nic).set(data)
+                    data = int(reader.read(handle))
+                    metric.labels(device_class="net", interface=nic).set(data)
+                    if rate_metric is not None:
+                        self.updateRate(rate_metric, "net", nic, data, self.__net_counter_bits)
                 except:
                     pass
 
         cxi_data = [
-            (self.__cxi_rx_data_paths, self.__rx_metric),
-            (self.__cxi_tx_data_paths, self.__tx_metric),
+            (self.__cxi_rx_data_paths, self.__rx_metric, self.__rx_rate_metric),
+            (self.__cxi_tx_data_paths, self.__tx_metric, self.__tx_rate_metric),
         ]
 
         # For CXI, estimate lower bound of the total amount of bytes:
         # aggregate values from all buckets using the minimum packet size of
         # each bucket.
-        for data_paths, metric in cxi_data:
+        for data_paths, metric, rate_metric in cxi_data:
             for nic, buckets in data_paths.items():
                 total = 0
-                for size, path in buckets.items():
+                complete = True
+                for size, handle in buckets.items():
                     try:
-                        with open(path, "r") as f:
-                            data = f.read().strip()
-                            fields = data.split("@")
-                            count = int(fields[0])
-                            total += count * size
+                        fields = reader.read(handle).split(b"@")
+                        count = int(fields[0])
+                        total += count * size
                     except:
-                        pass
+                        complete = False
                 metric.labels(device_class="cxi", interface=nic).set(total)
+                # a partial total would register as a drop (and a spurious reset) in the rate
+                if rate_metric is not None and complete:
+                    self.updateRate(rate_metric, "cxi", nic, total)
 
         ib_data = [
-            (self.__ib_rx_data_paths, self.__rx_metric),
-            (self.__ib_tx_data_paths, self.__tx_metric),
+            (self.__ib_rx_data_paths, self.__rx_metric, self.__rx_rate_metric),
+            (self.__ib_tx_data_paths, self.__tx_metric, self.__tx_rate_metric),
         ]
 
-        for data_paths, metric in ib_data:
-            for nic, path in data_paths.items():
+        for data_paths, metric, rate_metric in ib_data:
+            for nic, handle in data_paths.items():
                 try:
-                    with open(path, "r") as f:
-                        data = int(f.read().strip())
-                        # Counters for infiniband are reported as "octets divided by 4";
-                        # multiply to collect the expected value in bytes.
-                        metric.labels(device_class="infiniband", interface=nic).set(data * 4)
+                    data = int(reader.read(handle))
+                    # Counters for infiniband are reported as "octets divided by 4";
+                    # multiply to collect the expected value in bytes.
+                    metric.labels(device_class="infiniband", interface=nic).set(data * 4)
+                    if rate_metric is not None:
+                        self.updateRate(rate_metric, "infiniband", nic, data * 4)
                 except:
                     pass
 
         return
+
+    def updateRate(self, rate_metric, device_class, nic, value, bits=None):
+        """Update derived rate from the change in a cumulative counter since its previous sample
+
+        A decrease in value is treated as a wrap for counters of known width (bits) when the
+        wrapped difference is plausible, and as a counter reset when the value is back near zero
+        (closer to zero than to the previous value). Any other decrease is not trusted and the
+        rate is left unchanged. No rate is produced for the first sample of each counter.
+        """
+        key = (rate_metric, device_class, nic)
+        previous = self.__rate_state.get(key)
+        self.__rate_state[key] = (value, self.__sampleTime)
+        if previous is None:
+            return
+
+        previous_value, previous_time = previous
+        elapsed = self.__sampleTime - previous_time
+        if elapsed <= 0:
+            return
+
+        delta = value - previous_value
+        if delta < 0:
+            if bits and value + (1 << bits) - previous_value < (1 << (bits - 1)):
+                delta = value + (1 << bits) - previous_value
+            elif value < previous_value - value:
+                delta = value
+            else:
+                return
+        rate_metric.labels(device_class=device_class, interface=nic).set(delta / elapsed)
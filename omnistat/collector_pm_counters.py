@@ -40,6 +40,7 @@ from prometheus_client import Gauge
 
 import omnistat.utils as utils
 from omnistat.collector_base import Collector
+from omnistat.sysfs_reader import SysfsReader
 
 
 class PM_COUNTERS(Collector):
@@ -54,11 +55,14 @@ class PM_COUNTERS(Collector):
         self.__skipnames = ["power_cap", "startup", "freshness", "raw_scan_hz", "version", "generation", "_temp"]
         self.__gpumetrics = ["accel"]
 
-        # metric data structure for host oriented metrics
-        self.__pm_files_gpu = []  # entries: (gauge metric, filepath of source data)
+        # source files are opened once and re-read on every update
+        self.__reader = SysfsReader()
+
+        # metric data structure for gpu oriented metrics
+        self.__pm_files_gpu = []  # entries: (gauge child, reader handle of source data)
 
-        # metric data structure for gpu oriented
-        self.__pm_files_host = []  # entries: (gauge metric, filepath, gpuindex)
+        # metric data structure for host oriented metrics
+        self.__pm_files_host = []  # entries: (gauge child, reader handle of source data)
 
     def registerMetrics(self):
         """Register metrics of interest"""
@@ -105,42 +109,33 @@ class PM_COUNTERS(Collector):
                                 "--> [Registered] %s -> %s (gauge)" % (self.__prefix + metric_name, description)
                             )
 
-                        metric_entry = (gauge, str(file), gpu_id)
-                        self.__pm_files_gpu.append(metric_entry)
+                        handle = self.__reader.open(file)
+                        if handle is not None:
+                            metric_entry = (gauge.labels(card=gpu_id, vendor=self.__vendor), handle)
+                            self.__pm_files_gpu.append(metric_entry)
 
                     else:
                         metric_name = file.name + f"_{units}"
                         description = f"Node-level {metric_name} ({units_short})"
                         gauge = Gauge(self.__prefix + metric_name, description, labelnames=["vendor"])
-                        metric_entry = (gauge, str(file))
-                        self.__pm_files_host.append(metric_entry)
+                        handle = self.__reader.open(file)
+                        if handle is not None:
+                            metric_entry = (gauge.labels(vendor=self.__vendor), handle)
+                            self.__pm_files_host.append(metric_entry)
                         logging.info("--> [registered] %s -> %s (gauge)" % (self.__prefix + metric_name, description))
 
     def updateMetrics(self):
         """Update registered metrics of interest"""
 
-        # Host-level data...
-        for entry in self.__pm_files_host:
-            gaugeMetric = entry[0]
-            filePath = entry[1]
-            try:
-                with open(filePath, "r") as f:
-                    data = f.readline().strip().split()
-                    gaugeMetric.labels(vendor=self.__vendor).set(float(data[0]))
-            except:
-                pass
-
-        # GPU data...
-        for entry in self.__pm_files_gpu:
-            gaugeMetric = entry[0]
-            filePath = entry[1]
-            gpuIndex = entry[2]
-            try:
-                with open(filePath, "r") as f:
-                    data = f.readline().strip().split()
-                    gaugeMetric.labels(card=gpuIndex, vendor=self.__vendor).set(data[0])
-
-            except:
-                pass
+        reader = self.__reader
+
+        # Host-level and GPU data...
+        for entries in (self.__pm_files_host, self.__pm_files_gpu):
+            for gaugeMetric, handle in entries:
+                try:
+                    data = reader.read(handle).split(maxsplit=1)
+                    gaugeMetric.set(float(data[0]))
+                except:
+                    pass
 
         return
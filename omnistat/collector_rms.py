@@ -35,11 +35,14 @@ import logging
 import os
 import platform
 import sys
+import threading
+import time
 
 from prometheus_client import Gauge
 
 import omnistat.utils as utils
 from omnistat.collector_base import Collector
+from omnistat.file_watcher import FileWatcher
 
 
 class RMSJob(Collector):
@@ -59,13 +62,28 @@ class RMSJob(Collector):
 
         self.__resultsCached = {}
         self.__resultsStepCached = {}
+        self.__resultsFileCached = {}
         self.__annotationsCached = {}
+        self.__annotationsFileExists = False
+
+        # change notifications for job/step/annotation files: avoids file status queries at steady state
+        self.__watcher = FileWatcher()
+
+        # squeue mode: job state is refreshed by a background thread (at most once per update, and no more
+        # often than squeue_refresh_secs) and cached for use during updates
+        self.__squeueRefreshSecs = jobDetection.get("squeue_refresh_secs", 0.0)
+        self.__squeueResults = {}
+        self.__squeueLock = threading.Lock()
+        self.__squeueRequest = threading.Event()
+        self.__squeueThread = None
 
         # jobMode
         if self.__rmsJobMode == "file-based":
             logging.info(
                 "collector_rms: reading job information from prolog/epilog derived file (%s)" % self.__rmsJobFile
             )
+            self.__watcher.watch(self.__rmsJobStepFile)
+            self.__watcher.watch(self.__rmsJobFile)
         elif self.__rmsJobMode == "squeue":
             logging.info("collector_rms: configured to poll slurm periodically with squeue")
 
@@ -85,6 +103,7 @@ class RMSJob(Collector):
             flags = "-s -w " + hostname + " -h --Format=StepID"
             self.__squeue_steps = [command] + flags.split()
             logging.debug("squeue_exec = %s" % self.__squeue_query)
+            logging.info("collector_rms: minimum squeue refresh interval = %.1f secs" % self.__squeueRefreshSecs)
         else:
             logging.error("Unsupported slurm job data collection mode")
 
@@ -131,11 +150,17 @@ class RMSJob(Collector):
                     # 57735.10
                     # 57735.interactive
                     stepField = (data.stdout.splitlines()[0]).strip()
-                    jobstep = stepField.split(".")[1]
+                    jobstep = stepField.partition(".")[2]
                     if jobstep.isdigit():
                         results["RMS_STEP_ID"] = jobstep
 
         elif mode == "file-based":
+            # re-evaluate job files only when (potentially) changed
+            stepFileChanged = self.__watcher.changed(self.__rmsJobStepFile)
+            jobFileChanged = self.__watcher.changed(self.__rmsJobFile)
+            if not (stepFileChanged or jobFileChanged):
+                return self.__resultsFileCached
+
             # preference is given to job step file if it exists
             if os.path.isfile(self.__rmsJobStepFile):
                 # only read contents if modify timestamp has been updated
@@ -159,9 +184,49 @@ class RMSJob(Collector):
                     self.__resultsCached = results
                 else:
                     results = self.__resultsCached
+            self.__resultsFileCached = results
 
         return results
 
+    def startSlurmJobMonitor(self):
+        """Start background thread that refreshes cached job state via squeue"""
+        self.__squeueResults = self.querySlurmJob(mode="squeue")
+        self.__squeueThread = threading.Thread(target=self.refreshSlurmJob, name="omnistat-squeue", daemon=True)
+        self.__squeueThread.start()
+
+    def refreshSlurmJob(self):
+        """Refresh cached job state when requested by an update; failed queries retain the previous state"""
+        lastRefresh = time.monotonic()
+        failing = False
+        while True:
+            self.__squeueRequest.wait()
+            delay = lastRefresh + self.__squeueRefreshSecs - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            self.__squeueRequest.clear()
+            lastRefresh = time.monotonic()
+            try:
+                results = self.querySlurmJob(mode="squeue")
+            except Exception as e:
+                if not failing:
+                    logging.warning("[WARN]: collector_rms: squeue refresh failed, retaining job state (%s)" % e)
+                failing = True
+                continue
+            if failing:
+                logging.info("collector_rms: squeue refresh recovered")
+                failing = False
+            with self.__squeueLock:
+                self.__squeueResults = results
+
+    def currentJob(self):
+        """Return latest job info for local host"""
+        if self.__rmsJobMode == "squeue":
+            # job state is polled in the background: request a refresh for the next update
+            self.__squeueRequest.set()
+            with self.__squeueLock:
+                return self.__squeueResults
+        return self.querySlurmJob(mode=self.__rmsJobMode)
+
     def registerMetrics(self):
         """Register metrics of interest"""
 
@@ -178,12 +243,15 @@ class RMSJob(Collector):
         for metric in self.__RMSMetrics:
             logging.debug("--> Registered RMS metric = %s" % metric)
 
+        if self.__rmsJobMode == "squeue":
+            self.startSlurmJobMonitor()
+
     def updateMetrics(self):
         self.__RMSMetrics["info"].clear()
         self.__RMSMetrics["annotations"].clear()
         jobEnabled = False
 
-        results = self.querySlurmJob(mode=self.__rmsJobMode)
+        results = self.currentJob()
         if results:
             jobEnabled = True
 
@@ -203,17 +271,22 @@ class RMSJob(Collector):
             if self.__annotationsEnabled:
                 userFile = "/tmp/omnistat_%s_annotate.json" % results["RMS_JOB_USER"]
 
-                userFileExists = os.path.isfile(userFile)
-                if userFileExists:
-                    # only read contents if modify timestamp has been updated
-                    modTime = os.path.getmtime(userFile)
-                    if modTime > self.__rmsAnnotationsFileTimeStamp:
-                        with open(userFile, "r") as file:
-                            data = json.load(file)
-                        self.__rmsAnnotationsFileTimeStamp = modTime
-                        self.__annotationsCached = data
-                    else:
-                        data = self.__annotationsCached
+                if self.__watcher.changed(userFile):
+                    userFileExists = os.path.isfile(userFile)
+                    if userFileExists:
+                        # only read contents if modify timestamp has been updated
+                        modTime = os.path.getmtime(userFile)
+                        if modTime > self.__rmsAnnotationsFileTimeStamp:
+                            with open(userFile, "r") as file:
+                                data = json.load(file)
+                            self.__rmsAnnotationsFileTimeStamp = modTime
+                            self.__annotationsCached = data
+                        else:
+                            data = self.__annotationsCached
+                    self.__annotationsFileExists = userFileExists
+                else:
+                    userFileExists = self.__annotationsFileExists
+                    data = self.__annotationsCached
 
                 # Reset existing annotation in two scenarios:
                 #  1. Previous annotation stopped (file no longer present)
@@ -42,6 +42,7 @@ import ctypes
 import logging
 import os
 import sys
+from concurrent.futures import ThreadPoolExecutor
 
 from prometheus_client import Gauge, generate_latest
 
@@ -68,13 +69,18 @@ class rocprofiler_session_id_t(ctypes.Structure):
 
 
 class rocprofiler(Collector):
-    def __init__(self, rocm_path, metric_names):
+    def __init__(self, rocm_path, metric_names, session_mode="restart", max_counters_per_session=0):
         logging.debug("Initializing rocprofiler data collector")
 
         if metric_names == None or len(metric_names) == 0:
             logging.error("ERROR: Unexpected list of metrics.")
             sys.exit(4)
 
+        if session_mode not in ["restart", "continuous"]:
+            logging.error("ERROR: Unsupported rocprofiler session mode (%s)." % session_mode)
+            logging.error('--> expecting "restart" or "continuous"')
+            sys.exit(4)
+
         hip_lib = rocm_path + "/lib/libamdhip64.so"
         rocprofiler_lib = rocm_path + "/lib/librocprofiler64v2.so"
 
@@ -106,29 +112,59 @@ class rocprofiler(Collector):
 
         self.__metric = None
 
-        # Lists indexed by GPU ID:
+        # Counter sets: when more counters are requested than fit in a single
+        # session, counters are split into sets that are rotated (one active
+        # set per interval). Each set is identified by its offset in __names.
+        setSize = max_counters_per_session if max_counters_per_session > 0 else len(self.__names)
+        self.__offsets = list(range(0, len(self.__names), setSize))
+        self.__groups = [self.__names[k : k + setSize] for k in self.__offsets]
+        self.__active = 0
+
+        # Continuous mode keeps a single session running on each GPU and
+        # reports differences between successive polls. Rotating counter sets
+        # requires stopping sessions, so continuous mode only applies to a
+        # single set.
+        self.__continuous = session_mode == "continuous" and len(self.__groups) == 1
+        if session_mode == "continuous" and not self.__continuous:
+            logging.warning("[WARN]: rocprofiler counter sets are multiplexed, sessions restart on every rotation")
+
+        # Lists indexed by GPU ID and counter set:
         #  __sessions: stores rocprofiler device mode sessions
         #  __values: stores arrays of values returned by rocprofiler
+        # and indexed by GPU ID only:
+        #  __previous: stores last polled values (continuous mode)
+        #  __children: stores gauge children per counter
         self.__sessions = []
         self.__values = []
+        self.__previous = []
+        self.__children = []
 
         for i in range(self.__num_gpus):
-            self.__sessions.append((rocprofiler_session_id_t)())
-            self.__values.append((rocprofiler_device_profile_metric_t * len(self.__names))())
+            self.__sessions.append([(rocprofiler_session_id_t)() for group in self.__groups])
+            self.__values.append([(rocprofiler_device_profile_metric_t * len(group))() for group in self.__groups])
+            self.__previous.append([0.0] * len(self.__names))
 
         logging.info(f"--> rocprofiler: number of GPUs detected = {self.__num_gpus}")
         logging.info(f"--> rocprofiler: metrics = {self.__names}")
-
-        # Convert list of metrics to pass with ctypes
-        names_bytes = [bytes(i, "utf-8") for i in self.__names]
-        names_array = (ctypes.c_char_p * len(names_bytes))()
-        names_array[:] = names_bytes
-
-        # Create rocprofiler sessions for each GPU
-        for i in range(self.__num_gpus):
-            self.__librocprofiler.rocprofiler_device_profiling_session_create(
-                names_array, len(names_array), ctypes.byref(self.__sessions[i]), 0, i
-            )
+        logging.info(f"--> rocprofiler: session mode = {session_mode}, counter sets = {len(self.__groups)}")
+
+        # Create rocprofiler sessions for each GPU and counter set
+        for k, group in enumerate(self.__groups):
+            # Convert list of metrics to pass with ctypes
+            names_bytes = [bytes(i, "utf-8") for i in group]
+            names_array = (ctypes.c_char_p * len(names_bytes))()
+            names_array[:] = names_bytes
+
+            for i in range(self.__num_gpus):
+                self.__librocprofiler.rocprofiler_device_profiling_session_create(
+                    names_array, len(names_array), ctypes.byref(self.__sessions[i][k]), 0, i
+                )
+
+        # Poll GPUs concurrently in continuous mode (ctypes releases the GIL
+        # during native calls)
+        self.__executor = None
+        if self.__continuous and self.__num_gpus > 1:
+            self.__executor = ThreadPoolExecutor(max_workers=self.__num_gpus, thread_name_prefix="omnistat-rocprof")
 
         logging.info("--> rocprofiler initialized")
 
@@ -138,20 +174,46 @@ class rocprofiler(Collector):
         logging.info("--> [registered] %s (gauge)" % (metric_name))
 
         for i in range(self.__num_gpus):
-            self.__librocprofiler.rocprofiler_device_profiling_session_start(self.__sessions[i])
+            self.__children.append([self.__metric.labels(card=i, counter=name) for name in self.__names])
+            self.__librocprofiler.rocprofiler_device_profiling_session_start(self.__sessions[i][self.__active])
+
+    def pollDevice(self, gpu, group, nextGroup):
+        sessions = self.__sessions[gpu]
+        self.__librocprofiler.rocprofiler_device_profiling_session_poll(sessions[group], self.__values[gpu][group])
+
+        if not self.__continuous:
+            # Reset sessions to address issues with values (SWDEV-468600),
+            # rotating to the next counter set when multiplexing
+            self.__librocprofiler.rocprofiler_device_profiling_session_stop(sessions[group])
+            self.__librocprofiler.rocprofiler_device_profiling_session_start(sessions[nextGroup])
 
     def updateMetrics(self):
-        for i in range(self.__num_gpus):
-            self.__librocprofiler.rocprofiler_device_profiling_session_poll(self.__sessions[i], self.__values[i])
+        group = self.__active
+        nextGroup = (group + 1) % len(self.__groups)
+
+        if self.__executor:
+            futures = [self.__executor.submit(self.pollDevice, i, group, nextGroup) for i in range(self.__num_gpus)]
+            for future in futures:
+                future.result()
+        else:
+            for i in range(self.__num_gpus):
+                self.pollDevice(i, group, nextGroup)
 
-            # Reset sessions to address issues with values (SWDEV-468600)
-            self.__librocprofiler.rocprofiler_device_profiling_session_stop(self.__sessions[i])
-            self.__librocprofiler.rocprofiler_device_profiling_session_start(self.__sessions[i])
+        self.__active = nextGroup
 
+        # Counters from inactive sets retain values from their last interval
+        offset = self.__offsets[group]
         for i in range(self.__num_gpus):
-            for j, name in enumerate(self.__names):
-                array = self.__values[i]
+            array = self.__values[i][group]
+            children = self.__children[i]
+            previous = self.__previous[i]
+            for j in range(len(self.__groups[group])):
                 value = array[j].value.value
-                self.__metric.labels(card=i, counter=name).set(value)
+                if self.__continuous:
+                    # values accumulate since session start: report per-interval delta
+                    delta = value - previous[j]
+                    previous[j] = value
+                    value = delta if delta >= 0 else value
+                children[offset + j].set(value)
 
         return
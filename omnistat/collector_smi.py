@@ -43,6 +43,7 @@ rocm_utilization_percentage{card="0"} 0.0
 
 import ctypes
 import logging
+import math
 import os
 import sys
 from enum import IntEnum
@@ -50,11 +51,12 @@ from pathlib import Path
 
 from prometheus_client import CollectorRegistry, Gauge, generate_latest
 
-from omnistat.collector_base import Collector
+from omnistat import occupancy, topology
+from omnistat.collector_base import Collector, SamplingTiers
 from omnistat.utils import (
     count_compute_units,
-    get_occupancy,
     gpu_index_mapping_based_on_guids,
+    startupProfile,
 )
 
 rsmi_clk_names_dict = {"sclk": 0x0, "fclk": 0x1, "dcefclk": 0x2, "socclk": 0x3, "mclk": 0x4}
@@ -173,6 +175,80 @@ class rsmi_error_count_t(ctypes.Structure):
     _fields_ = [("correctable_err", ctypes.c_uint64), ("uncorrectable_err", ctypes.c_uint64)]
 
 
+class metrics_table_header_t(ctypes.Structure):
+    _fields_ = [
+        ("structure_size", ctypes.c_uint16),
+        ("format_revision", ctypes.c_uint8),
+        ("content_revision", ctypes.c_uint8),
+    ]
+
+
+class rsmi_gpu_metrics_t(ctypes.Structure):
+    """Leading (stable) portion of the GPU metrics table returned by rsmi_dev_gpu_metrics_info_get().
+    Newer library versions append additional fields; the trailing reserve keeps the buffer large
+    enough to accommodate them."""
+
+    _fields_ = [
+        ("common_header", metrics_table_header_t),
+        ("temperature_edge", ctypes.c_uint16),
+        ("temperature_hotspot", ctypes.c_uint16),
+        ("temperature_mem", ctypes.c_uint16),
+        ("temperature_vrgfx", ctypes.c_uint16),
+        ("temperature_vrsoc", ctypes.c_uint16),
+        ("temperature_vrmem", ctypes.c_uint16),
+        ("average_gfx_activity", ctypes.c_uint16),
+        ("average_umc_activity", ctypes.c_uint16),
+        ("average_mm_activity", ctypes.c_uint16),
+        ("average_socket_power", ctypes.c_uint16),
+        ("energy_accumulator", ctypes.c_uint64),
+        ("system_clock_counter", ctypes.c_uint64),
+        ("average_gfxclk_frequency", ctypes.c_uint16),
+        ("average_socclk_frequency", ctypes.c_uint16),
+        ("average_uclk_frequency", ctypes.c_uint16),
+        ("average_vclk0_frequency", ctypes.c_uint16),
+        ("average_dclk0_frequency", ctypes.c_uint16),
+        ("average_vclk1_frequency", ctypes.c_uint16),
+        ("average_dclk1_frequency", ctypes.c_uint16),
+        ("current_gfxclk", ctypes.c_uint16),
+        ("current_socclk", ctypes.c_uint16),
+        ("current_uclk", ctypes.c_uint16),
+        ("current_vclk0", ctypes.c_uint16),
+        ("current_dclk0", ctypes.c_uint16),
+        ("current_vclk1", ctypes.c_uint16),
+        ("current_dclk1", ctypes.c_uint16),
+        ("throttle_status", ctypes.c_uint32),
+        ("current_fan_speed", ctypes.c_uint16),
+        ("pcie_link_width", ctypes.c_uint16),
+        ("pcie_link_speed", ctypes.c_uint16),
+        ("padding", ctypes.c_uint16),
+        ("gfx_activity_acc", ctypes.c_uint32),
+        ("mem_activity_acc", ctypes.c_uint32),
+        ("temperature_hbm", ctypes.c_uint16 * 4),
+        ("firmware_timestamp", ctypes.c_uint64),
+        ("voltage_soc", ctypes.c_uint16),
+        ("voltage_gfx", ctypes.c_uint16),
+        ("voltage_mem", ctypes.c_uint16),
+        ("padding1", ctypes.c_uint16),
+        ("indep_throttle_status", ctypes.c_uint64),
+        ("current_socket_power", ctypes.c_uint16),
+        ("reserved", ctypes.c_uint8 * 4096),
+    ]
+
+
+# value used by the metrics table to flag fields unsupported on a given device
+RSMI_METRICS_TABLE_INVALID = 0xFFFF
+
+# metrics table fields corresponding to temperature locations used for rsmi_dev_temp_metric_get()
+rsmi_temperature_table_fields = {
+    "edge": ("temperature_edge", None),
+    "junction": ("temperature_hotspot", None),
+    "vram": ("temperature_mem", None),
+    "hbm_0": ("temperature_hbm", 0),
+    "hbm_1": ("temperature_hbm", 1),
+    "hbm_2": ("temperature_hbm", 2),
+    "hbm_3": ("temperature_hbm", 3),
+}
+
 # --
 
 
@@ -186,7 +262,13 @@ class ROCMSMI(Collector):
         self.__ecc_ras_monitoring = runtimeConfig["collector_ras_ecc"]
         self.__power_cap_monitoring = runtimeConfig["collector_power_capping"]
         self.__cu_occupancy_monitoring = runtimeConfig["collector_cu_occupancy"]
+        self.__metrics_table = runtimeConfig["collector_smi_metrics_table"]
+        self.__topologyCache = topology.open_cache(runtimeConfig)
         self.__eccBlocks = {}
+        self.__tableFields = {}
+        self.__tiers = SamplingTiers(
+            runtimeConfig["collector_sampling_tiers"], runtimeConfig["collector_sampling_tier_overrides"]
+        )
 
         rocm_path = runtimeConfig["collector_rocm_path"]
 
@@ -197,7 +279,8 @@ class ROCMSMI(Collector):
             logging.info("Runtime library loaded from %s" % smi_lib)
 
             # initialize smi library
-            ret_init = self.__libsmi.rsmi_init(0)
+            with startupProfile.phase("rocm_smi: library init"):
+                ret_init = self.__libsmi.rsmi_init(0)
             assert ret_init == 0
 
             # cache smi library version
@@ -273,7 +356,38 @@ class ROCMSMI(Collector):
             nodeMapping[i] = node.value
 
         self.__guidMapping = guidMapping
-        self.__indexMapping = gpu_index_mapping_based_on_guids(guidMapping, self.__num_gpus)
+
+        # map to HIP_VISIBLE_DEVICES indices and read version labels, reusing results cached on
+        # the node during previous launches when devices are unchanged
+        cache = self.__topologyCache
+        gpuTopology = cache.get("rocm_smi") if cache else None
+        guids = [guidMapping[i] for i in range(self.__num_gpus)]
+        if gpuTopology is None or gpuTopology["guids"] != guids:
+            with startupProfile.phase("rocm_smi: probe device topology"):
+                indexMapping = gpu_index_mapping_based_on_guids(guidMapping, self.__num_gpus)
+                versions = []
+                ver_str = ctypes.create_string_buffer(256)
+                for i in range(self.__num_gpus):
+                    device = ctypes.c_uint32(i)
+                    self.__libsmi.rsmi_dev_vbios_version_get(device, ver_str, 256)
+                    vbios = ver_str.value.decode()
+                    self.__libsmi.rsmi_dev_name_get(device, ver_str, 256)
+                    devtype = ver_str.value.decode()
+                    versions.append([vbios, devtype])
+            gpuTopology = {
+                "guids": guids,
+                "index_mapping": [indexMapping[i] for i in range(self.__num_gpus)],
+                "versions": versions,
+            }
+            if cache:
+                cache.put("rocm_smi", gpuTopology)
+        else:
+            logging.info("--> Using cached GPU topology (%s): %s" % (cache.path, gpuTopology["index_mapping"]))
+        self.__indexMapping = dict(enumerate(gpuTopology["index_mapping"]))
+
+        # cache device handles used for every sample
+        self.__devices = [ctypes.c_uint32(i) for i in range(self.__num_gpus)]
+        self.__vramTotal = [0] * self.__num_gpus
 
         # version info metric
         version_metric = Gauge(
@@ -281,17 +395,8 @@ class ROCMSMI(Collector):
             "GPU versioning information",
             labelnames=["card", "driver_ver", "vbios", "type", "schema"],
         )
-        for i in range(self.__num_gpus):
+        for i, (vbios, devtype) in enumerate(gpuTopology["versions"]):
             gpuLabel = self.__indexMapping[i]
-            ver_str = ctypes.create_string_buffer(256)
-            device = ctypes.c_uint32(i)
-
-            self.__libsmi.rsmi_dev_vbios_version_get(device, ver_str, 256)
-            vbios = ver_str.value.decode()
-
-            self.__libsmi.rsmi_dev_name_get(device, ver_str, 256)
-            devtype = ver_str.value.decode()
-
             version_metric.labels(
                 card=gpuLabel, driver_ver=self.__gpuDriverVer, vbios=vbios, type=devtype, schema=self.__schema
             ).set(1)
@@ -351,17 +456,19 @@ class ROCMSMI(Collector):
 
         # power
         self.registerGPUMetric(
-            self.__prefix + "average_socket_power_watts", "gauge", "Average Graphics Package Power (W)"
+            self.__prefix + "average_socket_power_watts", "gauge", "Average Graphics Package Power (W)", tier="fast"
         )
         # clock speeds
         self.registerGPUMetric(self.__prefix + "sclk_clock_mhz", "gauge", "current sclk clock speed (Mhz)")
         self.registerGPUMetric(self.__prefix + "mclk_clock_mhz", "gauge", "current mclk clock speed (Mhz)")
         # memory
-        self.registerGPUMetric(self.__prefix + "vram_total_bytes", "gauge", "VRAM Total Memory (B)")
+        self.registerGPUMetric(self.__prefix + "vram_total_bytes", "gauge", "VRAM Total Memory (B)", tier="slow")
         self.registerGPUMetric(self.__prefix + "vram_used_percentage", "gauge", "VRAM Memory in Use (%)")
-        self.registerGPUMetric(self.__prefix + "vram_busy_percentage", "gauge", "Memory controller activity (%)")
+        self.registerGPUMetric(
+            self.__prefix + "vram_busy_percentage", "gauge", "Memory controller activity (%)", tier="fast"
+        )
         # utilization
-        self.registerGPUMetric(self.__prefix + "utilization_percentage", "gauge", "GPU use (%)")
+        self.registerGPUMetric(self.__prefix + "utilization_percentage", "gauge", "GPU use (%)", tier="fast")
         # RAS counts
         if self.__ecc_ras_monitoring:
             state = rsmi_ras_err_state_t()
@@ -377,24 +484,40 @@ class ROCMSMI(Collector):
                         self.__eccBlocks[key] = block.value
                         metric = self.__prefix + "ras_%s_correctable_count" % key
                         self.registerGPUMetric(
-                            metric, "gauge", "number of correctable RAS events for %s block (count)" % key
+                            metric,
+                            "gauge",
+                            "number of correctable RAS events for %s block (count)" % key,
+                            tier="slow",
                         )
                         metric = self.__prefix + "ras_%s_uncorrectable_count" % key
                         self.registerGPUMetric(
-                            metric, "gauge", "number of uncorrectable RAS events for %s block (count)" % key
+                            metric,
+                            "gauge",
+                            "number of uncorrectable RAS events for %s block (count)" % key,
+                            tier="slow",
                         )
         # power cap
         if self.__power_cap_monitoring:
-            self.registerGPUMetric(self.__prefix + "power_cap_watts", "gauge", "Max power cap of device (W)")
+            self.registerGPUMetric(
+                self.__prefix + "power_cap_watts", "gauge", "Max power cap of device (W)", tier="slow"
+            )
 
         if self.__cu_occupancy_monitoring:
             # Measure the number CUs in each GPU node ID (KFD internal GPU index),
             # and map it to KFD GPU indices.
-            counts = count_compute_units(nodeMapping.values())
-            self.__num_compute_units = {i: counts[node] for i, node in nodeMapping.items()}
-            self.registerGPUMetric(self.__prefix + "num_compute_units", "gauge", "Number of compute units")
+            if "compute_units" not in gpuTopology:
+                counts = count_compute_units(nodeMapping.values())
+                gpuTopology["compute_units"] = [counts[nodeMapping[i]] for i in range(self.__num_gpus)]
+                if cache:
+                    cache.put("rocm_smi", gpuTopology)
+            self.__num_compute_units = dict(enumerate(gpuTopology["compute_units"]))
+            self.__occupancy = occupancy.shared(self.__guidMapping.values())
+            self.registerGPUMetric(self.__prefix + "num_compute_units", "gauge", "Number of compute units", tier="slow")
             self.registerGPUMetric(self.__prefix + "compute_unit_occupancy", "gauge", "Compute unit occupancy")
 
+        if self.__metrics_table:
+            self.probeMetricsTable()
+
         return
 
     def updateMetrics(self):
@@ -404,7 +527,7 @@ class ROCMSMI(Collector):
     # --------------------------------------------------------------------------------------
     # Additional custom methods unique to this collector
 
-    def registerGPUMetric(self, metricName, type, description, labelExtra=None):
+    def registerGPUMetric(self, metricName, type, description, labelExtra=None, tier="normal"):
         if metricName in self.__GPUmetrics:
             logging.error("Ignoring duplicate metric name addition: %s" % (metricName))
             return
@@ -414,12 +537,108 @@ class ROCMSMI(Collector):
                 for entry in labelExtra:
                     labelnames.append(entry)
             self.__GPUmetrics[metricName] = Gauge(metricName, description, labelnames=labelnames)
+            tier = self.__tiers.assign(metricName, tier)
 
-            logging.info("--> [registered] %s -> %s (gauge)" % (metricName, description))
+            logging.info("--> [registered] %s -> %s (gauge, %s tier)" % (metricName, description, tier))
         else:
             logging.error("Ignoring unknown metric type -> %s" % type)
         return
 
+    def probeMetricsTable(self):
+        """Determine which metrics can be served from a single read of the GPU metrics table
+        (rsmi_dev_gpu_metrics_info_get). Metrics whose table fields are not populated on this
+        hardware continue to use the individual per-field SMI queries."""
+
+        self.__gpuMetricsTable = rsmi_gpu_metrics_t()
+        ret = self.__libsmi.rsmi_dev_gpu_metrics_info_get(self.__devices[0], ctypes.byref(self.__gpuMetricsTable))
+        if ret != 0:
+            logging.info("--> GPU metrics table unavailable (ret = %i), using per-field queries" % ret)
+            return
+
+        table = self.__gpuMetricsTable
+
+        def tableValue(field, index):
+            value = getattr(table, field)
+            if index is not None:
+                value = value[index]
+            return value
+
+        # metric -> candidate table fields (field, array index), in order of preference
+        candidates = {
+            self.__prefix + "temperature_celsius": [rsmi_temperature_table_fields[self.__temp_location_name]],
+            self.__prefix + "average_socket_power_watts": [
+                ("average_socket_power", None),
+                ("current_socket_power", None),
+            ],
+            self.__prefix + "sclk_clock_mhz": [("current_gfxclk", None), ("average_gfxclk_frequency", None)],
+            self.__prefix + "mclk_clock_mhz": [("current_uclk", None), ("average_uclk_frequency", None)],
+            self.__prefix + "vram_busy_percentage": [("average_umc_activity", None)],
+            self.__prefix + "utilization_percentage": [("average_gfx_activity", None)],
+        }
+        if self.__temp_memory_location_index:
+            candidates[self.__prefix + "temperature_memory_celsius"] = [
+                rsmi_temperature_table_fields[self.__temp_memory_location_name]
+            ]
+
+        extraLabels = {
+            self.__prefix + "temperature_celsius": {"location": self.__temp_location_name},
+        }
+        if self.__temp_memory_location_index:
+            extraLabels[self.__prefix + "temperature_memory_celsius"] = {"location": self.__temp_memory_location_name}
+
+        # activity fields are legitimately zero on an idle GPU: only require them to be supported
+        activity = {self.__prefix + "vram_busy_percentage", self.__prefix + "utilization_percentage"}
+
+        for metric, fields in candidates.items():
+            for field, index in fields:
+                value = tableValue(field, index)
+                if value != RSMI_METRICS_TABLE_INVALID and (value > 0 or metric in activity):
+                    self.__tableFields[metric] = (field, index, extraLabels.get(metric, {}))
+                    break
+
+        logging.info(
+            "--> Using GPU metrics table (v%i.%i) for %i metric(s)"
+            % (table.common_header.format_revision, table.common_header.content_revision, len(self.__tableFields))
+        )
+        for metric, (field, index, labels) in self.__tableFields.items():
+            logging.debug("    %s <- %s%s" % (metric, field, "" if index is None else "[%i]" % index))
+        return
+
+    def burstMetrics(self):
+        """Burst source: power, utilization, and clocks for all GPUs from a GPU metrics table read"""
+        burst = ["average_socket_power_watts", "utilization_percentage", "vram_busy_percentage"]
+        burst += ["sclk_clock_mhz", "mclk_clock_mhz"]
+        fields = [(self.__prefix + name, self.__tableFields.get(self.__prefix + name)) for name in burst]
+        fields = [(metric, entry) for metric, entry in fields if entry is not None]
+        if not fields:
+            return None
+
+        series = []
+        for i in range(self.__num_gpus):
+            for metric, (field, index, labels) in fields:
+                series.append((metric, {"card": str(self.__indexMapping[i]), **labels}))
+
+        # separate table instance: sampled from the burst thread
+        table = rsmi_gpu_metrics_t()
+        tableRef = ctypes.byref(table)
+        getTable = self.__libsmi.rsmi_dev_gpu_metrics_info_get
+        devices = self.__devices
+
+        def sample():
+            values = []
+            for device in devices:
+                if getTable(device, tableRef) != 0:
+                    values.extend([math.nan] * len(fields))
+                    continue
+                for metric, (field, index, labels) in fields:
+                    value = getattr(table, field)
+                    if index is not None:
+                        value = value[index]
+                    values.append(math.nan if value == RSMI_METRICS_TABLE_INVALID else value)
+            return values
+
+        return series, sample
+
     def collect_data_incremental(self):
         # ---
         # Collect and parse latest GPU metrics from rocm SMI library
@@ -442,80 +661,128 @@ class ROCMSMI(Collector):
         pcie_max_pkt_sz = ctypes.c_uint64(0)
         ras_counts = rsmi_error_count_t()
 
+        # metrics to refresh during this update (remaining metrics retain previous values)
+        self.__tiers.tick()
+        due = {metric for metric in self.__GPUmetrics if self.__tiers.due(metric)}
+
+        # single scan of KFD processes for all GPUs
+        occupancyMetric = self.__prefix + "compute_unit_occupancy"
+        if self.__cu_occupancy_monitoring and occupancyMetric in due:
+            occupancyTotals = self.__occupancy.scan(occupancy.SHARED_MAX_AGE_SECS)
+
         for i in range(self.__num_gpus):
 
-            device = ctypes.c_uint32(i)
+            device = self.__devices[i]
             guid = self.__guidMapping[i]
             gpuLabel = self.__indexMapping[i]
 
+            # --
+            # single read of GPU metrics table (temperature, power, clocks, and activity in native units)
+            tableFields = self.__tableFields
+            if tableFields and not due.isdisjoint(tableFields):
+                table = self.__gpuMetricsTable
+                ret = self.__libsmi.rsmi_dev_gpu_metrics_info_get(device, ctypes.byref(table))
+                if ret == 0:
+                    unsupported = []
+                    for metric, (field, index, labels) in tableFields.items():
+                        if metric not in due:
+                            continue
+                        value = getattr(table, field)
+                        if index is not None:
+                            value = value[index]
+                        if value == RSMI_METRICS_TABLE_INVALID:
+                            unsupported.append(metric)
+                            continue
+                        self.__GPUmetrics[metric].labels(card=gpuLabel, **labels).set(value)
+                    if unsupported:
+                        # fall back to per-field queries for fields unsupported on this device
+                        tableFields = {
+                            metric: entry for metric, entry in tableFields.items() if metric not in unsupported
+                        }
+                else:
+                    # fall back to per-field queries for this device
+                    tableFields = {}
+
             # --
             # temperature [millidegrees Celcius, converted to degrees Celcius]
             metric = self.__prefix + "temperature_celsius"
-            ret = self.__libsmi.rsmi_dev_temp_metric_get(
-                device, self.__temp_location_index, temp_metric, ctypes.byref(temperature)
-            )
-            self.__GPUmetrics[metric].labels(card=gpuLabel, location=self.__temp_location_name).set(
-                temperature.value / 1000.0
-            )
+            if metric in due and metric not in tableFields:
+                ret = self.__libsmi.rsmi_dev_temp_metric_get(
+                    device, self.__temp_location_index, temp_metric, ctypes.byref(temperature)
+                )
+                self.__GPUmetrics[metric].labels(card=gpuLabel, location=self.__temp_location_name).set(
+                    temperature.value / 1000.0
+                )
 
             # --
             # HBM temperature [millidegrees Celcius, converted to degrees Celcius]
             if self.__temp_memory_location_index:
                 metric = self.__prefix + "temperature_memory_celsius"
-                ret = self.__libsmi.rsmi_dev_temp_metric_get(
-                    device, self.__temp_memory_location_index, temp_metric, ctypes.byref(temperature)
-                )
-                self.__GPUmetrics[metric].labels(card=gpuLabel, location=self.__temp_memory_location_name).set(
-                    temperature.value / 1000.0
-                )
+                if metric in due and metric not in tableFields:
+                    ret = self.__libsmi.rsmi_dev_temp_metric_get(
+                        device, self.__temp_memory_location_index, temp_metric, ctypes.byref(temperature)
+                    )
+                    self.__GPUmetrics[metric].labels(card=gpuLabel, location=self.__temp_memory_location_name).set(
+                        temperature.value / 1000.0
+                    )
 
             # --
             # average socket power [micro Watts, converted to Watts]
             metric = self.__prefix + "average_socket_power_watts"
-            if self.__smiVersion["major"] < 6:
-                ret = self.__libsmi.rsmi_dev_power_ave_get(device, 0, ctypes.byref(power))
-            else:
-                ret = self.__libsmi.rsmi_dev_power_get(device, ctypes.byref(power), ctypes.byref(power_type))
-            if ret == 0:
-                self.__GPUmetrics[metric].labels(card=gpuLabel).set(power.value / 1000000.0)
-            else:
-                self.__GPUmetrics[metric].labels(card=gpuLabel).set(0.0)
+            if metric in due and metric not in tableFields:
+                if self.__smiVersion["major"] < 6:
+                    ret = self.__libsmi.rsmi_dev_power_ave_get(device, 0, ctypes.byref(power))
+                else:
+                    ret = self.__libsmi.rsmi_dev_power_get(device, ctypes.byref(power), ctypes.byref(power_type))
+                if ret == 0:
+                    self.__GPUmetrics[metric].labels(card=gpuLabel).set(power.value / 1000000.0)
+                else:
+                    self.__GPUmetrics[metric].labels(card=gpuLabel).set(0.0)
 
             # --
             # clock speeds [Hz, converted to megaHz]
             metric = self.__prefix + "sclk_clock_mhz"
-            ret = self.__libsmi.rsmi_dev_gpu_clk_freq_get(device, freq_system_clock, ctypes.byref(freq))
-            self.__GPUmetrics[metric].labels(card=gpuLabel).set(freq.frequency[freq.current] / 1000000.0)
+            if metric in due and metric not in tableFields:
+                ret = self.__libsmi.rsmi_dev_gpu_clk_freq_get(device, freq_system_clock, ctypes.byref(freq))
+                self.__GPUmetrics[metric].labels(card=gpuLabel).set(freq.frequency[freq.current] / 1000000.0)
 
             metric = self.__prefix + "mclk_clock_mhz"
-            ret = self.__libsmi.rsmi_dev_gpu_clk_freq_get(device, freq_mem_clock, ctypes.byref(freq))
-            self.__GPUmetrics[metric].labels(card=gpuLabel).set(freq.frequency[freq.current] / 1000000.0)
+            if metric in due and metric not in tableFields:
+                ret = self.__libsmi.rsmi_dev_gpu_clk_freq_get(device, freq_mem_clock, ctypes.byref(freq))
+                self.__GPUmetrics[metric].labels(card=gpuLabel).set(freq.frequency[freq.current] / 1000000.0)
 
             # --
             # gpu memory [total_vram in bytes]
             metric = self.__prefix + "vram_total_bytes"
-            ret = self.__libsmi.rsmi_dev_memory_total_get(device, 0x0, ctypes.byref(vram_total))
-            self.__GPUmetrics[metric].labels(card=gpuLabel).set(vram_total.value)
+            if metric in due:
+                ret = self.__libsmi.rsmi_dev_memory_total_get(device, 0x0, ctypes.byref(vram_total))
+                self.__GPUmetrics[metric].labels(card=gpuLabel).set(vram_total.value)
+                self.__vramTotal[i] = vram_total.value
 
             metric = self.__prefix + "vram_used_percentage"
-            ret = self.__libsmi.rsmi_dev_memory_usage_get(device, 0x0, ctypes.byref(vram_used))
-            percentage = round(100.0 * vram_used.value / vram_total.value, 4)
-            self.__GPUmetrics[metric].labels(card=gpuLabel).set(percentage)
+            if metric in due:
+                ret = self.__libsmi.rsmi_dev_memory_usage_get(device, 0x0, ctypes.byref(vram_used))
+                percentage = round(100.0 * vram_used.value / self.__vramTotal[i], 4)
+                self.__GPUmetrics[metric].labels(card=gpuLabel).set(percentage)
 
             metric = self.__prefix + "vram_busy_percentage"
-            ret = self.__libsmi.rsmi_dev_memory_busy_percent_get(device, ctypes.byref(vram_busy))
-            self.__GPUmetrics[metric].labels(card=gpuLabel).set(vram_busy.value)
+            if metric in due and metric not in tableFields:
+                ret = self.__libsmi.rsmi_dev_memory_busy_percent_get(device, ctypes.byref(vram_busy))
+                self.__GPUmetrics[metric].labels(card=gpuLabel).set(vram_busy.value)
 
             # --
             # utilization
             metric = self.__prefix + "utilization_percentage"
-            ret = self.__libsmi.rsmi_dev_busy_percent_get(device, ctypes.byref(utilization))
-            self.__GPUmetrics[metric].labels(card=gpuLabel).set(utilization.value)
+            if metric in due and metric not in tableFields:
+                ret = self.__libsmi.rsmi_dev_busy_percent_get(device, ctypes.byref(utilization))
+                self.__GPUmetrics[metric].labels(card=gpuLabel).set(utilization.value)
 
             # --
             # RAS counts
             if self.__ecc_ras_monitoring:
                 for key, block in self.__eccBlocks.items():
+                    if self.__prefix + "ras_%s_correctable_count" % key not in due:
+                        continue
                     ret = self.__libsmi.rsmi_dev_ecc_count_get(device, block, ctypes.byref(ras_counts))
                     self.__GPUmetrics[self.__prefix + "ras_%s_correctable_count" % key].labels(card=gpuLabel).set(
                         ras_counts.correctable_err
@@ -527,18 +794,20 @@ class ROCMSMI(Collector):
             # power cap
             if self.__power_cap_monitoring:
                 metric = self.__prefix + "power_cap_watts"
-                ret = self.__libsmi.rsmi_dev_power_cap_get(device, 0x0, ctypes.byref(power))
-                # rsmi value in microwatts -> convert to watt
-                self.__GPUmetrics[metric].labels(card=gpuLabel).set(power.value / 1000000)
+                if metric in due:
+                    ret = self.__libsmi.rsmi_dev_power_cap_get(device, 0x0, ctypes.byref(power))
+                    # rsmi value in microwatts -> convert to watt
+                    self.__GPUmetrics[metric].labels(card=gpuLabel).set(power.value / 1000000)
 
             # --
             # CU occupancy
             if self.__cu_occupancy_monitoring:
                 metric = self.__prefix + "num_compute_units"
-                self.__GPUmetrics[metric].labels(card=gpuLabel).set(self.__num_compute_units[i])
+                if metric in due:
+                    self.__GPUmetrics[metric].labels(card=gpuLabel).set(self.__num_compute_units[i])
 
-                metric = self.__prefix + "compute_unit_occupancy"
-                cu_occupancy = get_occupancy(guid)
-                self.__GPUmetrics[metric].labels(card=gpuLabel).set(cu_occupancy)
+                if occupancyMetric in due:
+                    cu_occupancy = occupancyTotals[guid]
+                    self.__GPUmetrics[occupancyMetric].labels(card=gpuLabel).set(cu_occupancy)
 
         return
@@ -39,6 +39,7 @@ amdsmi_process_vram (card=0, pid=123, name=torchrun) 3784658734
 import logging
 
 from amdsmi import (
+    amdsmi_get_gpu_kfd_info,
     amdsmi_get_gpu_process_info,
     amdsmi_get_gpu_process_list,
     amdsmi_get_processor_handles,
@@ -46,8 +47,9 @@ from amdsmi import (
 )
 from prometheus_client import Gauge
 
+from omnistat import occupancy, topology
 from omnistat.collector_base import Collector
-from omnistat.utils import GPU_MAPPING_ORDER
+from omnistat.utils import gpu_index_mapping_based_on_guids, startupProfile
 
 
 def get_gpu_processes(device):
@@ -68,74 +70,134 @@ def get_gpu_processes(device):
 
 
 class AMDSMIProcess(Collector):
-    def __init__(self):
+    def __init__(self, runtimeConfig=None):
         logging.debug("Initializing AMD SMI Process data collector")
         self.__prefix = "amdsmi_process_"
-        amdsmi_init()
+        with startupProfile.phase("amd_smi_process: library init"):
+            amdsmi_init()
         logging.info("AMD SMI library API initialized for Process information collection")
         self.metric_vram = None
         self.metric_compute = None
+        self.metric_occupancy = None
         self.devices = []
-        self.process_metrics = {}
-        self.c = 0
+        self.__indexMapping = {}
+        self.__guidMapping = {}
+        self.__occupancy = None
+        self.__cuOccupancy = False
+        self.__topologyCache = None
+
+        # Active label sets, keyed by label values: (card, name, pid) or (card, name) when aggregating
+        # processes by name. Values are the (vram, compute[, occupancy]) gauge children.
+        self.__series = {}
+        self.__maxSeries = 256
+        self.__aggregate = False
+        if runtimeConfig is not None:
+            self.__maxSeries = runtimeConfig.get("collector_process_max_series", self.__maxSeries)
+            self.__aggregate = runtimeConfig.get("collector_process_aggregate", self.__aggregate)
+            self.__cuOccupancy = runtimeConfig.get("collector_process_cu_occupancy", self.__cuOccupancy)
+            self.__topologyCache = topology.open_cache(runtimeConfig)
+        self.__capWarned = False
 
     def registerMetrics(self):
         """Query number of devices and register metrics of interest"""
 
         devices = amdsmi_get_processor_handles()
         self.devices = devices
+
+        # determine GPU index mapping (ie. map kfd indices used by SMI lib to that of HIP_VISIBLE_DEVICES)
+        # (reusing results cached on the node during previous launches when KFD ids are unchanged)
+        cache = self.__topologyCache
+        gpuTopology = cache.get("amd_smi_process") if cache else None
+        guids = [amdsmi_get_gpu_kfd_info(device)["kfd_id"] for device in self.devices]
+        if gpuTopology is None or gpuTopology["guids"] != guids:
+            with startupProfile.phase("amd_smi_process: probe device topology"):
+                indexMapping = gpu_index_mapping_based_on_guids(dict(enumerate(guids)), len(self.devices))
+            gpuTopology = {"guids": guids, "index_mapping": [indexMapping[i] for i in range(len(self.devices))]}
+            if cache:
+                cache.put("amd_smi_process", gpuTopology)
+        guidMapping = dict(enumerate(gpuTopology["guids"]))
+        self.__guidMapping = guidMapping
+        self.__indexMapping = dict(enumerate(gpuTopology["index_mapping"]))
+
+        labels = ["card", "name"] if self.__aggregate else ["card", "name", "pid"]
         metric_vram = Gauge(
             f"{self.__prefix}vram",
             f"{self.__prefix}vram",
-            labelnames=["card", "name", "pid"],
+            labelnames=labels,
         )
         metric_compute = Gauge(
             f"{self.__prefix}compute",
             f"{self.__prefix}compute",
-            labelnames=["card", "name", "pid"],
+            labelnames=labels,
         )
         self.metric_vram = metric_vram
         self.metric_compute = metric_compute
+        if self.__cuOccupancy:
+            self.__occupancy = occupancy.shared(guidMapping.values())
+            self.metric_occupancy = Gauge(
+                f"{self.__prefix}cu_occupancy",
+                "Compute unit occupancy of process (# of CUs)",
+                labelnames=labels,
+            )
+        logging.info("--> process series limit = %i, aggregate by name = %s" % (self.__maxSeries, self.__aggregate))
         self.updateMetrics()
         return
 
     def updateMetrics(self):
 
-        self.collect_data_incremental()
-        # Remove old labels for process not currently running
-        for metric, counter in self.process_metrics.items():
-            if counter < self.c:
-                # catch edge case for multiple metrics with same name
-                try:
-                    self.metric_vram.remove(metric[0], metric[1], metric[2])
-                except:
-                    pass
-                try:
-                    self.metric_compute.remove(metric[0], metric[1], metric[2])
-                except:
-                    pass
+        current = self.collect_data_incremental()
+
+        # Remove labels for processes no longer running
+        for key in self.__series.keys() - current.keys():
+            self.metric_vram.remove(*key)
+            self.metric_compute.remove(*key)
+            if self.metric_occupancy is not None:
+                self.metric_occupancy.remove(*key)
+            del self.__series[key]
+
+        # Add new processes (up to the series limit) and update values
+        for key, values in current.items():
+            children = self.__series.get(key)
+            if children is None:
+                if len(self.__series) >= self.__maxSeries:
+                    if not self.__capWarned:
+                        logging.warning(
+                            "[WARN]: GPU process series limit reached (%i), omitting additional processes"
+                            % self.__maxSeries
+                        )
+                        self.__capWarned = True
+                    continue
+                children = (self.metric_vram.labels(*key), self.metric_compute.labels(*key))
+                if self.metric_occupancy is not None:
+                    children += (self.metric_occupancy.labels(*key),)
+                self.__series[key] = children
+            for child, value in zip(children, values):
+                child.set(value)
 
         return
 
     def collect_data_incremental(self):
-        self.c += 1
+        """Return current (vram, compute[, occupancy]) usage indexed by label values"""
+        current = {}
+        if self.__occupancy is not None:
+            self.__occupancy.scan(occupancy.SHARED_MAX_AGE_SECS)
+            processOccupancy = self.__occupancy.processes
         for idx, device in enumerate(self.devices):
+            card = str(self.__indexMapping[idx])
+            guid = self.__guidMapping[idx]
 
             processes = get_gpu_processes(device)
 
             for process in processes:
-                metric_tuple = (str(GPU_MAPPING_ORDER[idx]), process["name"], str(process["pid"]))
-
-                self.process_metrics[metric_tuple] = self.c
-                self.metric_vram.labels(
-                    card=str(GPU_MAPPING_ORDER[idx]),
-                    name=str(process["name"]),
-                    pid=str(process["pid"]),
-                ).set(process["memory_usage"]["vram_mem"])
-                self.metric_compute.labels(
-                    card=str(GPU_MAPPING_ORDER[idx]),
-                    name=str(process["name"]),
-                    pid=str(process["pid"]),
-                ).set(process["engine_usage"]["gfx"])
-
-        return
+                values = (process["memory_usage"]["vram_mem"], process["engine_usage"]["gfx"])
+                if self.__occupancy is not None:
+                    values += (processOccupancy.get(str(process["pid"]), {}).get(guid, 0),)
+                if self.__aggregate:
+                    key = (card, str(process["name"]))
+                    if key in current:
+                        values = tuple(a + b for a, b in zip(values, current[key]))
+                else:
+                    key = (card, str(process["name"]), str(process["pid"]))
+                current[key] = values
+
+        return current
@@ -41,7 +41,9 @@ rocm_mlck_clock_mhz{card="0"} 1200.0
 rocm_slck_clock_mhz{card="0"} 300.0
 """
 
+import ctypes
 import logging
+import math
 import statistics
 import sys
 
@@ -49,11 +51,13 @@ import amdsmi as smi
 import packaging.version
 from prometheus_client import Gauge
 
-from omnistat.collector_base import Collector
+from omnistat import occupancy, topology
+from omnistat.collector_base import Collector, SamplingTiers
 from omnistat.utils import (
     count_compute_units,
-    get_occupancy,
     gpu_index_mapping_based_on_guids,
+    probe_concurrently,
+    startupProfile,
 )
 
 
@@ -91,7 +95,8 @@ class AMDSMI(Collector):
         logging.debug("Initializing AMD SMI data collector")
         self.__prefix = "rocm_"
         self.__schema = 1.0
-        smi.amdsmi_init()
+        with startupProfile.phase("amd_smi: library init"):
+            smi.amdsmi_init()
         logging.info("AMD SMI library API initialized")
         self.__num_gpus = 0
         self.__devices = []
@@ -100,7 +105,13 @@ class AMDSMI(Collector):
         self.__ecc_ras_monitoring = runtimeConfig["collector_ras_ecc"]
         self.__power_cap_monitoring = runtimeConfig["collector_power_capping"]
         self.__cu_occupancy_monitoring = runtimeConfig["collector_cu_occupancy"]
+        self.__sweepEnabled = runtimeConfig["collector_amd_smi_sweep"]
+        self.__sweep = None
+        self.__topologyCache = topology.open_cache(runtimeConfig)
         self.__eccBlocks = {}
+        self.__tiers = SamplingTiers(
+            runtimeConfig["collector_sampling_tiers"], runtimeConfig["collector_sampling_tier_overrides"]
+        )
         # verify minimum version met
         check_min_version("24.7.1")
 
@@ -113,6 +124,31 @@ class AMDSMI(Collector):
             tracked_metrics[metricName] = result[smiName]
         return tracked_metrics
 
+    def probeTopology(self, kfdInfo):
+        """Query version labels of all GPUs concurrently, and map KFD to HIP indices
+
+        Args:
+            kfdInfo (list): KFD info of each device (indexed by SMI device index)
+        Returns:
+            dict: per-device lists (indexed by SMI device index) of guids, nodes, versions and
+            index_mapping, as saved in the topology cache
+        """
+
+        def probe(device):
+            vbios = smi.amdsmi_get_gpu_vbios_info(device)["part_number"]
+            devtype = smi.amdsmi_get_gpu_asic_info(device)["market_name"]
+            driverVer = smi.amdsmi_get_gpu_driver_info(device)["driver_version"]
+            return [driverVer, vbios, devtype]
+
+        guids = [info["kfd_id"] for info in kfdInfo]
+        indexMapping = gpu_index_mapping_based_on_guids(dict(enumerate(guids)), self.__num_gpus)
+        return {
+            "guids": guids,
+            "nodes": [info["node_id"] for info in kfdInfo],
+            "versions": probe_concurrently(probe, self.__devices),
+            "index_mapping": [indexMapping[i] for i in range(self.__num_gpus)],
+        }
+
     def registerMetrics(self):
         """Query number of devices and register metrics of interest"""
 
@@ -131,15 +167,23 @@ class AMDSMI(Collector):
         numGPUs_metric.set(self.__num_gpus)
 
         # determine GPU index mapping (ie. map kfd indices used by SMI lib to that of HIP_VISIBLE_DEVICES)
-        guidMapping = {}
-        nodeMapping = {}
-        for index, device in enumerate(self.__devices):
-            kfd_info = smi.amdsmi_get_gpu_kfd_info(device)
-            guidMapping[index] = kfd_info["kfd_id"]
-            nodeMapping[index] = kfd_info["node_id"]
-
+        # and version labels, reusing results cached on the node during previous launches when the
+        # KFD ids of all devices are unchanged (e.g. same partition mode)
+        cache = self.__topologyCache
+        gpuTopology = cache.get("amd_smi") if cache else None
+        kfdInfo = [smi.amdsmi_get_gpu_kfd_info(device) for device in devices]
+        if gpuTopology is None or gpuTopology["guids"] != [info["kfd_id"] for info in kfdInfo]:
+            with startupProfile.phase("amd_smi: probe device topology"):
+                gpuTopology = self.probeTopology(kfdInfo)
+            if cache:
+                cache.put("amd_smi", gpuTopology)
+        else:
+            logging.info("--> Using cached GPU topology (%s): %s" % (cache.path, gpuTopology["index_mapping"]))
+
+        guidMapping = dict(enumerate(gpuTopology["guids"]))
+        nodeMapping = dict(enumerate(gpuTopology["nodes"]))
         self.__guidMapping = guidMapping
-        self.__indexMapping = gpu_index_mapping_based_on_guids(guidMapping, self.__num_gpus)
+        self.__indexMapping = dict(enumerate(gpuTopology["index_mapping"]))
 
         # version info metric
         version_metric = Gauge(
@@ -148,16 +192,8 @@ class AMDSMI(Collector):
             labelnames=["card", "driver_ver", "vbios", "type", "schema"],
         )
 
-        for idx, device in enumerate(self.__devices):
+        for idx, (gpuDriverVer, vbios, devtype) in enumerate(gpuTopology["versions"]):
             gpuLabel = self.__indexMapping[idx]
-            vbios_info = smi.amdsmi_get_gpu_vbios_info(device)
-            vbios = vbios_info["part_number"]
-            asic_info = smi.amdsmi_get_gpu_asic_info(device)
-            devtype = asic_info["market_name"]
-
-            driver_info = smi.amdsmi_get_gpu_driver_info(device)
-            gpuDriverVer = driver_info["driver_version"]
-
             version_metric.labels(
                 card=gpuLabel, driver_ver=gpuDriverVer, vbios=vbios, type=devtype, schema=self.__schema
             ).set(1)
@@ -298,8 +334,13 @@ class AMDSMI(Collector):
         if self.__cu_occupancy_monitoring:
             # Measure the number CUs in each GPU node ID (KFD internal GPU index),
             # and map it to KFD GPU indices.
-            counts = count_compute_units(nodeMapping.values())
-            self.__num_compute_units = {i: counts[node] for i, node in nodeMapping.items()}
+            if "compute_units" not in gpuTopology:
+                counts = count_compute_units(nodeMapping.values())
+                gpuTopology["compute_units"] = [counts[node] for node in gpuTopology["nodes"]]
+                if cache:
+                    cache.put("amd_smi", gpuTopology)
+            self.__num_compute_units = dict(enumerate(gpuTopology["compute_units"]))
+            self.__occupancy = occupancy.shared(self.__guidMapping.values())
             self.__GPUMetrics["num_compute_units"] = Gauge(
                 self.__prefix + "num_compute_units", "Number of compute units", labelnames=["card"]
             )
@@ -307,44 +348,223 @@ class AMDSMI(Collector):
                 self.__prefix + "compute_unit_occupancy", "Compute unit occupancy (# of CUs)", labelnames=["card"]
             )
 
+        # assign sampling tiers: slowly changing values are refreshed less often when tiers are configured
+        tierDefaults = {
+            "utilization_percentage": "fast",
+            "average_socket_power_watts": "fast",
+            "vram_busy_percentage": "fast",
+            "vram_total_bytes": "slow",
+            "power_cap_watts": "slow",
+            "num_compute_units": "slow",
+        }
+        self.__tierNames = {}
+        for key in self.__GPUMetrics:
+            name = key.removeprefix(self.__prefix)
+            tier = "slow" if name.startswith("ras_") else tierDefaults.get(name, "normal")
+            self.__tierNames[key] = self.__prefix + name
+            tier = self.__tiers.assign(self.__prefix + name, tier)
+            logging.debug("--> %s assigned to %s tier" % (self.__prefix + name, tier))
+        self.__tableKeys = {self.__prefix + name for name in self.__metricMapping.values()}
+        self.__vramTotal = [0] * self.__num_gpus
+
+        if self.__sweepEnabled:
+            self.setupSweep()
+
+        return
+
+    def setupSweep(self):
+        """Map tracked metrics to columns of a direct library sweep with pre-bound gauges"""
+        try:
+            from omnistat.amdsmi_sweep import AMDSMISweep
+
+            sweep = AMDSMISweep(self.__devices)
+            columns = {}
+
+            # last mapping wins for metrics with multiple candidate fields (as in get_gpu_metrics)
+            tableFields = {metricName: smiName for smiName, metricName in self.__metricMapping.items()}
+            for metricName, smiName in tableFields.items():
+                labels = {}
+                if metricName in self.__source_labels:
+                    labels["source"] = self.__source_labels[metricName]
+                columns[self.__prefix + metricName] = (sweep.addTableField(metricName, smiName), labels)
+
+            vram = smi.AmdSmiMemoryType.VRAM
+            columns["vram_total_bytes"] = (sweep.addMemory("vram_total", "amdsmi_get_gpu_memory_total", vram), {})
+            columns["vram_used_percentage"] = (sweep.addMemory("vram_used", "amdsmi_get_gpu_memory_usage", vram), {})
+
+            current = smi.AmdSmiTemperatureMetric.CURRENT
+            columns["temperature_celsius"] = (
+                sweep.addTemperature("temperature", self.__temp_location_index, current),
+                {"location": self.__temp_location_name},
+            )
+            if self.__temp_memory_location_index:
+                columns["temperature_memory_celsius"] = (
+                    sweep.addTemperature("temperature_memory", self.__temp_memory_location_index, current),
+                    {"location": self.__temp_memory_location_name},
+                )
+
+            if self.__ecc_ras_monitoring:
+                for key, block in self.__eccBlocks.items():
+                    for kind in ["correctable", "uncorrectable", "deferred"]:
+                        metric = "ras_%s_%s_count" % (key, kind)
+                        columns[metric] = (sweep.addEccCount(metric, block, "%s_count" % kind), {})
+
+            if self.__power_cap_monitoring:
+                columns["power_cap_watts"] = (sweep.addPowerCap("power_cap", 1.0 / 1000000), {})
+
+            sweep.sweep()
+        except (AttributeError, TypeError, ImportError, ctypes.ArgumentError) as e:
+            logging.info("--> Direct amd-smi sweep unavailable (%s), using Python interface" % e)
+            return
+
+        # (key, column, kind, gauge child per GPU); kind flags VRAM values needing conversion
+        self.__sweepEntries = []
+        for key, (column, labels) in columns.items():
+            kind = key if key in ["vram_total_bytes", "vram_used_percentage"] else None
+            gauge = self.__GPUMetrics[key]
+            children = [gauge.labels(card=self.__indexMapping[idx], **labels) for idx in range(self.__num_gpus)]
+            self.__sweepEntries.append((key, column, kind, children))
+        self.__sweepPlans = {}
+        self.__sweep = sweep
+        logging.info("--> Using direct amd-smi sweep for %i metric(s) per GPU" % sweep.width)
         return
 
+    def burstMetrics(self):
+        """Burst source: power, utilization, and clocks for all GPUs from the GPU metrics table"""
+        burst = ["average_socket_power_watts", "utilization_percentage", "vram_busy_percentage"]
+        burst += ["sclk_clock_mhz", "mclk_clock_mhz"]
+        tableFields = {metricName: smiName for smiName, metricName in self.__metricMapping.items()}
+        fields = [(name, tableFields[name]) for name in burst if name in tableFields]
+
+        series = []
+        for idx in range(self.__num_gpus):
+            for metricName, smiName in fields:
+                labels = {"card": str(self.__indexMapping[idx])}
+                if metricName in self.__source_labels:
+                    labels["source"] = self.__source_labels[metricName]
+                series.append((self.__prefix + metricName, labels))
+
+        # prefer direct library reads (separate instance: sampled from the burst thread)
+        try:
+            from omnistat.amdsmi_sweep import AMDSMISweep
+
+            sweep = AMDSMISweep(self.__devices)
+            for metricName, smiName in fields:
+                sweep.addTableField(metricName, smiName)
+            return series, lambda: sweep.sweep().tolist()
+        except (AttributeError, TypeError, ImportError) as e:
+            logging.debug("Direct amd-smi reads unavailable for burst sampling (%s)" % e)
+
+        devices = self.__devices
+
+        def sample():
+            values = []
+            for device in devices:
+                metrics = smi.amdsmi_get_gpu_metrics_info(device)
+                for metricName, smiName in fields:
+                    value = metrics[smiName]
+                    values.append(value if isinstance(value, (int, float)) else math.nan)
+            return values
+
+        return series, sample
+
     def updateMetrics(self):
         self.collect_data_incremental()
         return
 
     def collect_data_incremental(self):
+        # metrics to refresh during this update (remaining metrics retain previous values)
+        self.__tiers.tick()
+        due = {key for key, name in self.__tierNames.items() if self.__tiers.due(name)}
+
+        if self.__sweep is not None:
+            self.collectSweep(due)
+        else:
+            self.collectQueries(due)
+
+        # CU occupancy
+        if self.__cu_occupancy_monitoring:
+            if "compute_unit_occupancy" in due:
+                totals = self.__occupancy.scan(occupancy.SHARED_MAX_AGE_SECS)
+            for idx in range(self.__num_gpus):
+                cardId = self.__indexMapping[idx]
+                if "num_compute_units" in due:
+                    self.__GPUMetrics["num_compute_units"].labels(card=cardId).set(self.__num_compute_units[idx])
+
+                if "compute_unit_occupancy" in due:
+                    cu_occupancy = totals[self.__guidMapping[idx]]
+                    self.__GPUMetrics["compute_unit_occupancy"].labels(card=cardId).set(cu_occupancy)
+
+        return
+
+    def collectSweep(self, due):
+        """Update metrics from a single sweep of all GPUs"""
+        dueKey = frozenset(due)
+        plan = self.__sweepPlans.get(dueKey)
+        if plan is None:
+            entries = [entry for entry in self.__sweepEntries if entry[0] in due]
+            plan = (frozenset(entry[1] for entry in entries), entries)
+            self.__sweepPlans[dueKey] = plan
+        columns, entries = plan
+        if not entries:
+            return
+
+        values = self.__sweep.sweep(columns)
+        width = self.__sweep.width
+        for key, column, kind, children in entries:
+            for idx, child in enumerate(children):
+                value = values[idx * width + column]
+                # retain previous value when unavailable
+                if value != value:
+                    continue
+                if kind == "vram_total_bytes":
+                    self.__vramTotal[idx] = value
+                elif kind == "vram_used_percentage":
+                    if not self.__vramTotal[idx]:
+                        continue
+                    value = round(100.0 * value / self.__vramTotal[idx], 4)
+                child.set(value)
+        return
+
+    def collectQueries(self, due):
+        """Update metrics with per-GPU queries through the amdsmi Python interface"""
         for idx, device in enumerate(self.__devices):
 
             # map GPU index
             cardId = self.__indexMapping[idx]
-            guid = self.__guidMapping[idx]
 
             #  stats available via get_gpu_metrics
-            metrics = self.get_gpu_metrics(device)
-
-            for metricName, value in metrics.items():
-                metric = self.__GPUMetrics[self.__prefix + metricName]
-                if metricName in self.__source_labels:
-                    metric.labels(card=cardId, source=self.__source_labels[metricName]).set(value)
-                else:
-                    metric.labels(card=cardId).set(value)
+            if not due.isdisjoint(self.__tableKeys):
+                metrics = self.get_gpu_metrics(device)
+
+                for metricName, value in metrics.items():
+                    if self.__prefix + metricName not in due:
+                        continue
+                    metric = self.__GPUMetrics[self.__prefix + metricName]
+                    if metricName in self.__source_labels:
+                        metric.labels(card=cardId, source=self.__source_labels[metricName]).set(value)
+                    else:
+                        metric.labels(card=cardId).set(value)
 
             # additional gpu memory-related stats
-            device_total_vram = smi.amdsmi_get_gpu_memory_total(device, smi.AmdSmiMemoryType.VRAM)
-            self.__GPUMetrics["vram_total_bytes"].labels(card=cardId).set(device_total_vram)
-            vram_used_bytes = smi.amdsmi_get_gpu_memory_usage(device, smi.AmdSmiMemoryType.VRAM)
-            percentage = round(100.0 * vram_used_bytes / device_total_vram, 4)
-            self.__GPUMetrics["vram_used_percentage"].labels(card=cardId).set(percentage)
+            if "vram_total_bytes" in due:
+                device_total_vram = smi.amdsmi_get_gpu_memory_total(device, smi.AmdSmiMemoryType.VRAM)
+                self.__GPUMetrics["vram_total_bytes"].labels(card=cardId).set(device_total_vram)
+                self.__vramTotal[idx] = device_total_vram
+            if "vram_used_percentage" in due:
+                vram_used_bytes = smi.amdsmi_get_gpu_memory_usage(device, smi.AmdSmiMemoryType.VRAM)
+                percentage = round(100.0 * vram_used_bytes / self.__vramTotal[idx], 4)
+                self.__GPUMetrics["vram_used_percentage"].labels(card=cardId).set(percentage)
 
             # additional temperature-related stats
-            temperature = smi.amdsmi_get_temp_metric(
-                device, self.__temp_location_index, smi.AmdSmiTemperatureMetric.CURRENT
-            )
-            self.__GPUMetrics["temperature_celsius"].labels(card=cardId, location=self.__temp_location_name).set(
-                temperature
-            )
-            if self.__temp_memory_location_index:
+            if "temperature_celsius" in due:
+                temperature = smi.amdsmi_get_temp_metric(
+                    device, self.__temp_location_index, smi.AmdSmiTemperatureMetric.CURRENT
+                )
+                self.__GPUMetrics["temperature_celsius"].labels(card=cardId, location=self.__temp_location_name).set(
+                    temperature
+                )
+            if self.__temp_memory_location_index and "temperature_memory_celsius" in due:
                 hbm_temperature = smi.amdsmi_get_temp_metric(
                     device, self.__temp_memory_location_index, smi.AmdSmiTemperatureMetric.CURRENT
                 )
@@ -355,6 +575,8 @@ class AMDSMI(Collector):
             # RAS counts
             if self.__ecc_ras_monitoring:
                 for key, block in self.__eccBlocks.items():
+                    if "ras_%s_correctable_count" % key not in due:
+                        continue
                     ecc_error_counts = smi.amdsmi_get_gpu_ecc_count(device, block)
                     metric = "ras_%s_correctable_count" % key
                     self.__GPUMetrics["ras_%s_correctable_count" % key].labels(card=cardId).set(
@@ -367,15 +589,8 @@ class AMDSMI(Collector):
                         ecc_error_counts["deferred_count"]
                     )
             # power-capping
-            if self.__power_cap_monitoring:
+            if self.__power_cap_monitoring and "power_cap_watts" in due:
                 power_info = smi.amdsmi_get_power_cap_info(device)
                 self.__GPUMetrics["power_cap_watts"].labels(card=cardId).set(power_info["power_cap"] / 1000000)
 
-            # CU occupancy
-            if self.__cu_occupancy_monitoring:
-                self.__GPUMetrics["num_compute_units"].labels(card=cardId).set(self.__num_compute_units[idx])
-
-                cu_occupancy = get_occupancy(guid)
-                self.__GPUMetrics["compute_unit_occupancy"].labels(card=cardId).set(cu_occupancy)
-
         return
@@ -0,0 +1,270 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+
+"""Tree-based fan-out for launching and stopping user-mode exporters
+
+Hosts are split into up to `degree` subtrees. The first host of each subtree
+is reached over ssh and runs this module to act on its own node and relay the
+request to the remainder of its subtree, so the number of ssh sessions opened
+by any single node is bounded by the fan-out degree and the overall latency
+grows with the depth of the tree (log_degree(N)) rather than the number of
+hosts. Every relay waits for its local exporter to become ready (or to shut
+down) and reports the result for its subtree on stdout as a single JSON line,
+aggregating acknowledgements back up the tree.
+
+When run as a resource manager step (srun/flux exec), the "run" action keeps
+the exporter in the foreground of the step and prints a readiness line once
+the exporter is listening, while the "stop" action shuts down the local
+exporter; the resource manager takes care of the fan-out.
+"""
+
+import argparse
+import concurrent.futures
+import json
+import logging
+import os
+import platform
+import shlex
+import socket
+import subprocess
+import sys
+import time
+import urllib.request
+
+READY = "omnistat-ready"
+STOPPED = "omnistat-stopped"
+FAILED = "omnistat-failed"
+
+# time reserved at each level of the tree to report back to the parent
+LEVEL_MARGIN = 5.0
+
+
+def split(hosts, degree):
+    """Split hosts into up to degree contiguous subtrees of similar size"""
+    groups = []
+    count = min(degree, len(hosts))
+    start = 0
+    for i in range(count):
+        end = start + (len(hosts) - start) // (count - i)
+        groups.append(hosts[start:end])
+        start = end
+    return groups
+
+
+def portOpen(port, host="localhost"):
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
+        s.settimeout(1.0)
+        return s.connect_ex((host, int(port))) == 0
+
+
+def waitForPort(port, timeout, host="localhost", open=True):
+    """Wait until port is listening (open=True) or closed (open=False)"""
+    deadline = time.monotonic() + timeout
+    delay = 0.05
+    while True:
+        if portOpen(port, host) == open:
+            return True
+        if time.monotonic() >= deadline:
+            return False
+        time.sleep(min(delay, max(deadline - time.monotonic(), 0)))
+        delay = min(2 * delay, 1.0)
+
+
+def launchLocal(command, port, timeout, logfile):
+    """Spawn command in the background and wait for it to listen on port"""
+    nohup_command = f"nohup sh -c {shlex.quote(command)} > {logfile} 2>&1 &"
+    try:
+        subprocess.run(["sh", "-c", nohup_command], stdin=subprocess.DEVNULL, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        return False
+    return waitForPort(port, timeout)
+
+
+def shutdownLocal(port, timeout):
+    """Request the local exporter to shut down and wait for its port to close"""
+    if not portOpen(port):
+        return True
+    try:
+        urllib.request.urlopen(f"http://localhost:{port}/shutdown", timeout=timeout).read()
+    except Exception:
+        # connection may drop while the exporter terminates
+        pass
+    return waitForPort(port, timeout, open=False)
+
+
+class FanoutLauncher:
+    def __init__(self, action, command=None, port=8001, degree=32, timeout=120.0, ssh_retries=2):
+        """
+        Args:
+            action (str): "launch" or "shutdown"
+            command (str): exporter command line (launch only)
+            port (int): exporter listening port
+            degree (int): maximum number of subtrees relayed by each node
+            timeout (float): time allowed for the whole subtree to report back
+            ssh_retries (int): number of alternative subtree heads tried after an ssh failure
+        """
+        self.__action = action
+        self.__command = command
+        self.__port = int(port)
+        self.__degree = max(int(degree), 1)
+        self.__timeout = timeout
+        self.__retries = ssh_retries
+
+    def run(self, hosts, local=None):
+        """Act on the local node (when local names it) and relay to hosts
+
+        Returns:
+            dict: "ok" and "failed" lists of hosts
+        """
+        start = time.monotonic()
+        results = {"ok": [], "failed": []}
+        groups = split(list(hosts), self.__degree)
+
+        with concurrent.futures.ThreadPoolExecutor(max_workers=len(groups) + 1) as executor:
+            futures = [executor.submit(self.relay, group, start) for group in groups]
+            if local:
+                localFuture = executor.submit(self.local, max(self.__timeout - LEVEL_MARGIN, 1.0))
+            for future in futures:
+                result = future.result()
+                results["ok"].extend(result["ok"])
+                results["failed"].extend(result["failed"])
+            if local:
+                results["ok" if localFuture.result() else "failed"].append(local)
+
+        return results
+
+    def local(self, timeout):
+        if self.__action == "launch":
+            hostname = platform.node().split(".", 1)[0]
+            return launchLocal(self.__command, self.__port, timeout, f"/tmp/omnistat_launch_{hostname}.log")
+        return shutdownLocal(self.__port, timeout)
+
+    def relay(self, group, start):
+        """Hand a subtree to its first host; on ssh failure, retry with the next host as head"""
+        results = {"ok": [], "failed": []}
+        attempt = 0
+        while group:
+            remaining = self.__timeout - (time.monotonic() - start)
+            if remaining <= LEVEL_MARGIN:
+                break
+            head, rest = group[0], group[1:]
+            result = self.ssh(head, rest, remaining)
+            if result is not None:
+                results["ok"].extend(result["ok"])
+                results["failed"].extend(result["failed"])
+                return results
+            logging.warning("[fanout] Unable to relay to %s (%i hosts in subtree)" % (head, len(group)))
+            results["failed"].append(head)
+            group = rest
+            attempt += 1
+            if attempt > self.__retries:
+                break
+        results["failed"].extend(group)
+        return results
+
+    def ssh(self, head, rest, timeout):
+        """Run a relay for rest on head; returns its results or None if the relay could not be reached"""
+        args = [
+            sys.executable,
+            "-m",
+            "omnistat.fanout",
+            "--action",
+            self.__action,
+            "--port",
+            str(self.__port),
+            "--degree",
+            str(self.__degree),
+            "--timeout",
+            "%.1f" % (timeout - LEVEL_MARGIN),
+            "--local",
+            head,
+        ]
+        if rest:
+            args += ["--hosts", ",".join(rest)]
+        if self.__command:
+            args += ["--command", self.__command]
+        remote = f"cd {shlex.quote(os.getcwd())} && PYTHONPATH={shlex.quote(':'.join(sys.path))} "
+        remote += " ".join(shlex.quote(arg) for arg in args)
+
+        logging.debug("[fanout] relaying %i hosts via %s" % (len(rest) + 1, head))
+        try:
+            process = subprocess.run(
+                ["ssh", head, remote], stdin=subprocess.DEVNULL, capture_output=True, text=True, timeout=timeout
+            )
+        except subprocess.TimeoutExpired:
+            return None
+        for line in reversed(process.stdout.splitlines()):
+            if line.startswith("{"):
+                try:
+                    return json.loads(line)
+                except ValueError:
+                    break
+        return None
+
+
+def runStep(command, port, timeout):
+    """Resource manager step: run exporter in the foreground, acknowledging once it is listening"""
+    hostname = platform.node().split(".", 1)[0]
+    process = subprocess.Popen(["sh", "-c", command], stdin=subprocess.DEVNULL)
+    deadline = time.monotonic() + timeout
+    while not portOpen(port):
+        if process.poll() is not None or time.monotonic() >= deadline:
+            print(f"{FAILED} {hostname}", flush=True)
+            break
+        time.sleep(0.1)
+    else:
+        print(f"{READY} {hostname}", flush=True)
+    return process.wait()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Omnistat exporter fan-out relay")
+    parser.add_argument("--action", choices=["launch", "shutdown", "run", "stop"], required=True)
+    parser.add_argument("--command", help="exporter command line")
+    parser.add_argument("--port", type=int, default=8001)
+    parser.add_argument("--degree", type=int, default=32)
+    parser.add_argument("--timeout", type=float, default=120.0)
+    parser.add_argument("--hosts", help="comma separated hosts relayed by this node", default="")
+    parser.add_argument("--local", help="name of this node as known to the launcher")
+    args = parser.parse_args()
+
+    logging.basicConfig(format="%(message)s", level=logging.INFO, stream=sys.stderr)
+
+    if args.action == "run":
+        sys.exit(runStep(args.command, args.port, args.timeout))
+
+    if args.action == "stop":
+        hostname = platform.node().split(".", 1)[0]
+        stopped = shutdownLocal(args.port, args.timeout)
+        print(f"{STOPPED if stopped else FAILED} {hostname}", flush=True)
+        return
+
+    hosts = [host for host in args.hosts.split(",") if host]
+    launcher = FanoutLauncher(args.action, args.command, args.port, args.degree, args.timeout)
+    print(json.dumps(launcher.run(hosts, local=args.local)), flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,143 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+"""Change notification for files of interest
+
+Uses Linux inotify (via ctypes) to watch the parent directories of files
+of interest. Callers poll changed(path), which performs a single
+non-blocking read of pending events; at steady state (no changes) this
+incurs no file system metadata queries. When inotify is unavailable, every
+path is always reported as changed so callers fall back to checking files
+directly.
+"""
+
+import ctypes
+import ctypes.util
+import logging
+import os
+import struct
+
+IN_MODIFY = 0x00000002
+IN_ATTRIB = 0x00000004
+IN_CLOSE_WRITE = 0x00000008
+IN_MOVED_FROM = 0x00000040
+IN_MOVED_TO = 0x00000080
+IN_CREATE = 0x00000100
+IN_DELETE = 0x00000200
+IN_Q_OVERFLOW = 0x00004000
+IN_NONBLOCK = os.O_NONBLOCK
+IN_CLOEXEC = os.O_CLOEXEC
+
+WATCH_MASK = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE | IN_DELETE
+
+EVENT_HEADER = struct.Struct("iIII")
+
+
+class FileWatcher:
+    def __init__(self, paths=()):
+        self.__fd = None
+        self.__dirs = {}
+        self.__watches = {}
+        self.__changed = set()
+        self.__seen = set()
+
+        try:
+            libc = ctypes.CDLL(ctypes.util.find_library("c") or "libc.so.6", use_errno=True)
+            self.__inotify_add_watch = libc.inotify_add_watch
+            self.__inotify_add_watch.argtypes = [ctypes.c_int, ctypes.c_char_p, ctypes.c_uint32]
+            fd = libc.inotify_init1(IN_NONBLOCK | IN_CLOEXEC)
+            if fd < 0:
+                raise OSError(ctypes.get_errno(), "inotify_init1 failed")
+            self.__fd = fd
+        except (OSError, AttributeError) as e:
+            logging.info("inotify unavailable, falling back to polling file status (%s)" % e)
+
+        for path in paths:
+            self.watch(path)
+
+    @property
+    def enabled(self):
+        return self.__fd is not None
+
+    def watch(self, path):
+        """Track changes to path (via a watch on its parent directory)"""
+        path = os.path.abspath(path)
+        if self.__fd is None or path in self.__seen:
+            return
+        directory = os.path.dirname(path)
+        if directory not in self.__dirs:
+            wd = self.__inotify_add_watch(self.__fd, directory.encode(), WATCH_MASK)
+            if wd < 0:
+                logging.warning("[WARN]: Unable to watch %s, falling back to polling file status" % directory)
+                self.close()
+                return
+            self.__dirs[directory] = wd
+            self.__watches[wd] = directory
+        self.__seen.add(path)
+        # report as changed on first query so callers read initial state
+        self.__changed.add(path)
+
+    def changed(self, path):
+        """Return True if path may have changed (been created, modified, or removed) since the last query"""
+        if self.__fd is None:
+            return True
+        path = os.path.abspath(path)
+        if path not in self.__seen:
+            self.watch(path)
+            if self.__fd is None:
+                return True
+        self.readEvents()
+        if path in self.__changed:
+            self.__changed.discard(path)
+            return True
+        return False
+
+    def readEvents(self):
+        """Drain pending inotify events (non-blocking)"""
+        while True:
+            try:
+                data = os.read(self.__fd, 65536)
+            except BlockingIOError:
+                return
+            offset = 0
+            while offset < len(data):
+                wd, mask, cookie, length = EVENT_HEADER.unpack_from(data, offset)
+                offset += EVENT_HEADER.size
+                name = data[offset : offset + length].rstrip(b"\0").decode(errors="replace")
+                offset += length
+                if mask & IN_Q_OVERFLOW:
+                    # events lost: treat everything as changed
+                    self.__changed.update(self.__seen)
+                    continue
+                directory = self.__watches.get(wd)
+                if directory is None:
+                    continue
+                path = os.path.join(directory, name)
+                if path in self.__seen:
+                    self.__changed.add(path)
+
+    def close(self):
+        if self.__fd is not None:
+            os.close(self.__fd)
+            self.__fd = None
@@ -0,0 +1,193 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+
+"""Local figure-of-merit (FOM) channel for user-mode Omnistat
+
+Applications on the same node can report FOM samples to the user-mode exporter
+through a Unix datagram socket instead of HTTP requests. Each datagram contains
+one or more samples, one per line:
+
+    <name> <value> [<timestamp_msecs>]
+
+Samples without a timestamp are stamped on receipt. Sends are non-blocking: if
+the exporter is not running (or its receive queue is full) samples are dropped
+rather than stalling the application. A C and Fortran client is available in
+misc/fom.
+
+The socket path is taken from OMNISTAT_FOM_SOCKET, defaulting to
+/tmp/omnistat_${USER}_fom.sock. File can also be imported for direct Python
+usage:
+
+    from omnistat.fom import omnistat_fom
+    fom = omnistat_fom()
+    fom.report("iterations_per_sec", 12.5)
+"""
+
+import errno
+import logging
+import os
+import select
+import socket
+import threading
+import time
+
+# maximum size of a single datagram
+MAX_DATAGRAM = 65536
+
+
+def default_socket_path():
+    path = os.environ.get("OMNISTAT_FOM_SOCKET")
+    if path:
+        return path
+    return "/tmp/omnistat_" + os.environ.get("USER", str(os.getuid())) + "_fom.sock"
+
+
+def parse_datagram(data, receive_msecs):
+    """Parse FOM samples in a datagram; returns a list of {name, value, timestamp_msecs} entries"""
+    samples = []
+    for line in data.decode(errors="replace").splitlines():
+        fields = line.split()
+        if not fields:
+            continue
+        if len(fields) not in (2, 3):
+            logging.warning("[WARN]: Ignoring malformed FOM sample (%s)" % line)
+            continue
+        timestamp_msecs = receive_msecs
+        if len(fields) == 3:
+            try:
+                timestamp_msecs = int(fields[2])
+            except ValueError:
+                logging.warning("[WARN]: Ignoring FOM sample with invalid timestamp (%s)" % line)
+                continue
+        samples.append({"name": fields[0], "value": fields[1], "timestamp_msecs": timestamp_msecs})
+    return samples
+
+
+class FOMSocket:
+    """Receiver thread accepting FOM datagrams on a Unix socket"""
+
+    def __init__(self, path, deliver):
+        """
+        Args:
+            path (str): socket location
+            deliver (callable): deliver(samples) hands a list of parsed samples to the exporter
+        """
+        self.__path = path
+        self.__deliver = deliver
+        self.__received = 0
+        self.__stopping = False
+        self.__thread = None
+
+        # remove stale socket left behind by a previous run
+        try:
+            os.unlink(path)
+        except FileNotFoundError:
+            pass
+        self.__socket = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+        # create the socket owner-only so other users can't connect in a window before permissions are set
+        umask = os.umask(0o077)
+        try:
+            self.__socket.bind(path)
+        finally:
+            os.umask(umask)
+        self.__socket.setblocking(False)
+
+    @property
+    def path(self):
+        return self.__path
+
+    @property
+    def received(self):
+        """Number of samples received"""
+        return self.__received
+
+    def start(self):
+        self.__thread = threading.Thread(target=self.receive, name="omnistat-fom", daemon=True)
+        self.__thread.start()
+
+    def stop(self):
+        self.__stopping = True
+        if self.__thread is not None:
+            self.__thread.join()
+        self.__socket.close()
+        try:
+            os.unlink(self.__path)
+        except FileNotFoundError:
+            pass
+
+    def receive(self):
+        """Receiver thread: deliver samples from all datagrams queued when the socket becomes readable"""
+        while not self.__stopping:
+            readable, _, _ = select.select([self.__socket], [], [], 1.0)
+            if not readable:
+                continue
+            receive_msecs = int(time.time() * 1000)
+            samples = []
+            while True:
+                try:
+                    data = self.__socket.recv(MAX_DATAGRAM)
+                except (BlockingIOError, InterruptedError):
+                    break
+                except OSError as e:
+                    logging.warning("[WARN]: FOM socket receive failed (%s)" % e)
+                    return
+                samples.extend(parse_datagram(data, receive_msecs))
+            if samples:
+                self.__received += len(samples)
+                self.__deliver(samples)
+
+
+class omnistat_fom:
+    """Client for reporting FOM samples to the local user-mode exporter"""
+
+    def __init__(self, path=None):
+        self.path = path or default_socket_path()
+        self.socket = socket.socket(socket.AF_UNIX, socket.SOCK_DGRAM)
+        self.socket.setblocking(False)
+        self.dropped = 0
+
+    def report(self, name, value, timestamp_msecs=None):
+        """Report a single FOM sample; returns False if the sample was dropped"""
+        return self.report_batch([(name, value, timestamp_msecs)])
+
+    def report_batch(self, samples):
+        """Report (name, value[, timestamp_msecs]) samples in a single datagram; returns False if dropped"""
+        lines = []
+        for sample in samples:
+            if len(sample) > 2 and sample[2] is not None:
+                lines.append("%s %r %i" % (sample[0], float(sample[1]), sample[2]))
+            else:
+                lines.append("%s %r" % (sample[0], float(sample[1])))
+        try:
+            self.socket.sendto("\n".join(lines).encode(), self.path)
+        except OSError as e:
+            if e.errno not in (errno.EAGAIN, errno.ENOENT, errno.ECONNREFUSED, errno.ENOBUFS):
+                raise
+            self.dropped += len(lines)
+            return False
+        return True
+
+    def close(self):
+        self.socket.close()
@@ -28,6 +28,7 @@
 # or more custom collector(s).
 # --
 
+import concurrent.futures
 import configparser
 import importlib.resources
 import logging
@@ -35,11 +36,15 @@ import os
 import platform
 import re
 import sys
+import threading
+import time
 from pathlib import Path
 
-from prometheus_client import CollectorRegistry, generate_latest
+from prometheus_client import CollectorRegistry, Counter, Gauge, Histogram, generate_latest
 
-from omnistat import utils
+from omnistat import topology, utils
+from omnistat.collector_base import SamplingTiers
+from omnistat.scheduler import DeadlineScheduler
 
 
 class Monitor:
@@ -68,6 +73,9 @@ class Monitor:
         self.runtimeConfig["collector_enable_network"] = config["omnistat.collectors"].getboolean(
             "enable_network", True
         )
+        self.runtimeConfig["collector_network_rates"] = config["omnistat.collectors"].getboolean(
+            "enable_network_rates", False
+        )
         self.runtimeConfig["collector_enable_vendor_counters"] = config["omnistat.collectors"].getboolean(
             "enable_vendor_counters", False
         )
@@ -83,7 +91,18 @@ class Monitor:
         self.runtimeConfig["collector_enable_amd_smi_process"] = config["omnistat.collectors"].getboolean(
             "enable_amd_smi_process", False
         )
+        self.runtimeConfig["collector_process_max_series"] = config["omnistat.collectors"].getint(
+            "process_max_series", 256
+        )
+        self.runtimeConfig["collector_process_aggregate"] = config["omnistat.collectors"].getboolean(
+            "process_aggregate_by_name", False
+        )
+        self.runtimeConfig["collector_process_cu_occupancy"] = config["omnistat.collectors"].getboolean(
+            "process_cu_occupancy", False
+        )
         self.runtimeConfig["collector_enable_events"] = config["omnistat.collectors"].getboolean("enable_events", False)
+        event_types = config["omnistat.collectors"].get("event_types", "THERMAL_THROTTLE")
+        self.runtimeConfig["collector_event_types"] = [name.strip() for name in event_types.split(",") if name.strip()]
         self.runtimeConfig["collector_port"] = config["omnistat.collectors"].get("port", 8001)
         self.runtimeConfig["collector_rocm_path"] = config["omnistat.collectors"].get("rocm_path", "/opt/rocm")
         self.runtimeConfig["collector_ras_ecc"] = config["omnistat.collectors"].getboolean("enable_ras_ecc", True)
@@ -93,11 +112,56 @@ class Monitor:
         self.runtimeConfig["collector_power_capping"] = config["omnistat.collectors"].getboolean(
             "enable_power_cap", False
         )
+        self.runtimeConfig["collector_smi_metrics_table"] = config["omnistat.collectors"].getboolean(
+            "enable_smi_metrics_table", True
+        )
+        self.runtimeConfig["collector_amd_smi_sweep"] = config["omnistat.collectors"].getboolean(
+            "enable_amd_smi_sweep", False
+        )
 
         self.runtimeConfig["collector_enable_rocprofiler"] = config["omnistat.collectors"].getboolean(
             "enable_rocprofiler", False
         )
 
+        # optional concurrent collector updates: each collector is bounded by its own deadline
+        self.runtimeConfig["collector_parallel_updates"] = config["omnistat.collectors"].getboolean(
+            "enable_parallel_updates", False
+        )
+        self.runtimeConfig["collector_update_timeout_secs"] = config["omnistat.collectors"].getfloat(
+            "update_timeout_secs", 1.0
+        )
+
+        # scrape responses: optionally share recent snapshots between scrapers
+        self.runtimeConfig["collector_scrape_cache_secs"] = config["omnistat.collectors"].getfloat(
+            "scrape_cache_secs", 0.0
+        )
+
+        # sampling mode: collectors are updated on each scrape, or by a background sampler thread on
+        # its own schedule with scrapes served from the latest published snapshot
+        self.runtimeConfig["collector_sampling_mode"] = config["omnistat.collectors"].get("sampling_mode", "scrape")
+        if self.runtimeConfig["collector_sampling_mode"] not in ["scrape", "background"]:
+            logging.error("")
+            logging.error(
+                '[ERROR]: Unsupported sampling_mode setting (%s): use "scrape" or "background"'
+                % self.runtimeConfig["collector_sampling_mode"]
+            )
+            sys.exit(1)
+        self.runtimeConfig["collector_sampling_interval_secs"] = config["omnistat.collectors"].getfloat(
+            "sampling_interval_secs", 1.0
+        )
+
+        # optional on-node cache of GPU topology discovered at startup (see topology.py)
+        self.runtimeConfig["collector_topology_cache"] = None
+        if config["omnistat.collectors"].getboolean("enable_topology_cache", True):
+            self.runtimeConfig["collector_topology_cache"] = config["omnistat.collectors"].get(
+                "topology_cache", topology.default_cache_path()
+            )
+
+        # optional self-metrics tracking cost of individual collector updates
+        self.runtimeConfig["collector_stats"] = config["omnistat.collectors"].getboolean(
+            "enable_collector_stats", False
+        )
+
         allowed_ips = config["omnistat.collectors"].get("allowed_ips", "127.0.0.1")
         # convert comma-separated string into list
         self.runtimeConfig["collector_allowed_ips"] = re.split(r",\s*", allowed_ips)
@@ -116,12 +180,44 @@ class Monitor:
             self.jobDetection["stepfile"] = config["omnistat.collectors.rms"].get(
                 "step_detection_file", "/tmp/omni_rmsjobinfo_step"
             )
+            self.jobDetection["squeue_refresh_secs"] = config["omnistat.collectors.rms"].getfloat(
+                "squeue_refresh_secs", 0.0
+            )
             if config.has_option("omnistat.collectors.rms", "host_skip"):
                 self.runtimeConfig["rms_collector_host_skip"] = config["omnistat.collectors.rms"]["host_skip"]
 
         self.runtimeConfig["rocprofiler_metrics"] = []
         if config.has_option("omnistat.collectors.rocprofiler", "metrics"):
             self.runtimeConfig["rocprofiler_metrics"] = config["omnistat.collectors.rocprofiler"]["metrics"].split(",")
+        self.runtimeConfig["rocprofiler_session_mode"] = "restart"
+        self.runtimeConfig["rocprofiler_max_counters_per_session"] = 0
+        if config.has_section("omnistat.collectors.rocprofiler"):
+            section = config["omnistat.collectors.rocprofiler"]
+            self.runtimeConfig["rocprofiler_session_mode"] = section.get("session_mode", "restart")
+            self.runtimeConfig["rocprofiler_max_counters_per_session"] = section.getint("max_counters_per_session", 0)
+
+        # sampling tiers: metrics assigned to slower tiers are refreshed every N updates
+        self.runtimeConfig["collector_sampling_tiers"] = {}
+        self.runtimeConfig["collector_sampling_tier_overrides"] = {}
+        for tier in SamplingTiers.tiers:
+            period = 1
+            if config.has_option("omnistat.collectors.tiers", tier):
+                period = config["omnistat.collectors.tiers"].getint(tier)
+            if period < 1:
+                logging.error("")
+                logging.error("[ERROR]: Sampling period for %s tier must be >= 1 (%s)" % (tier, period))
+                sys.exit(1)
+            self.runtimeConfig["collector_sampling_tiers"][tier] = period
+            if config.has_option("omnistat.collectors.tiers", "%s_metrics" % tier):
+                metrics = config["omnistat.collectors.tiers"]["%s_metrics" % tier]
+                for metric in re.split(r",\s*", metrics.strip()):
+                    if metric:
+                        self.runtimeConfig["collector_sampling_tier_overrides"][metric] = tier
+        if max(self.runtimeConfig["collector_sampling_tiers"].values()) > 1:
+            logging.info(
+                "Sampling tiers enabled (updates/refresh): %s"
+                % ", ".join("%s=%i" % item for item in self.runtimeConfig["collector_sampling_tiers"].items())
+            )
 
         # defined global prometheus metrics
         self.__globalMetrics = {}
@@ -130,6 +226,23 @@ class Monitor:
         # define desired collectors
         self.__collectors = []
 
+        # state for concurrent collector updates (enabled in initMetrics)
+        self.__executor = None
+        self.__pendingUpdates = {}
+        self.__missedDeadlines = {}
+
+        # self-metrics for collector update costs (enabled in initMetrics)
+        self.__collectorStats = None
+
+        # background sampler state (enabled via startSampler)
+        self.__sampler = None
+        self.__snapshot = None
+
+        # shared scrape snapshot (enabled via scrape_cache_secs)
+        self.__scrapeLock = threading.Lock()
+        self.__scrapeSnapshot = None
+        self.__scrapeTime = None
+
         # allow for disablement of resource manager data collector via regex match
         if self.runtimeConfig["collector_enable_rms"]:
             if config.has_option("omnistat.collectors.rms", "host_skip"):
@@ -144,6 +257,8 @@ class Monitor:
         return
 
     def initMetrics(self):
+        profile = utils.startupProfile
+        init_start = time.perf_counter()
 
         if self.runtimeConfig["collector_enable_vendor_counters"]:
             from omnistat.collector_pm_counters import PM_COUNTERS
@@ -153,7 +268,7 @@ class Monitor:
         if self.runtimeConfig["collector_enable_network"]:
             from omnistat.collector_network import NETWORK
 
-            self.__collectors.append(NETWORK())
+            self.__collectors.append(NETWORK(runtimeConfig=self.runtimeConfig))
 
         if self.runtimeConfig["collector_enable_rocm_smi"]:
             from omnistat.collector_smi import ROCMSMI
@@ -166,7 +281,7 @@ class Monitor:
         if self.runtimeConfig["collector_enable_amd_smi_process"]:
             from omnistat.collector_smi_process import AMDSMIProcess
 
-            self.__collectors.append(AMDSMIProcess())
+            self.__collectors.append(AMDSMIProcess(runtimeConfig=self.runtimeConfig))
         if self.runtimeConfig["collector_enable_rms"]:
             from omnistat.collector_rms import RMSJob
 
@@ -179,24 +294,217 @@ class Monitor:
         if self.runtimeConfig["collector_enable_events"]:
             from omnistat.collector_events import ROCMEvents
 
-            self.__collectors.append(ROCMEvents())
+            self.__collectors.append(ROCMEvents(runtimeConfig=self.runtimeConfig))
 
         if self.runtimeConfig["collector_enable_rocprofiler"]:
             from omnistat.collector_rocprofiler import rocprofiler
 
             self.__collectors.append(
-                rocprofiler(self.runtimeConfig["collector_rocm_path"], self.runtimeConfig["rocprofiler_metrics"])
+                rocprofiler(
+                    self.runtimeConfig["collector_rocm_path"],
+                    self.runtimeConfig["rocprofiler_metrics"],
+                    session_mode=self.runtimeConfig["rocprofiler_session_mode"],
+                    max_counters_per_session=self.runtimeConfig["rocprofiler_max_counters_per_session"],
+                )
             )
 
+        profile.record("load and initialize collectors", time.perf_counter() - init_start)
+
         # Initialize all metrics
         for collector in self.__collectors:
-            collector.registerMetrics()
+            with profile.phase("register metrics: %s" % type(collector).__name__):
+                collector.registerMetrics()
+
+        if self.runtimeConfig["collector_stats"]:
+            self.registerCollectorStats()
 
         # Gather metrics on startup
         for collector in self.__collectors:
-            collector.updateMetrics()
+            with profile.phase("first update: %s" % type(collector).__name__):
+                self.updateCollector(collector)
+
+        if self.runtimeConfig["collector_parallel_updates"] and len(self.__collectors) > 1:
+            self.__executor = concurrent.futures.ThreadPoolExecutor(
+                max_workers=len(self.__collectors), thread_name_prefix="omnistat-collector"
+            )
+            for collector in self.__collectors:
+                self.__missedDeadlines[collector] = 0
+            logging.info(
+                "Concurrent collector updates enabled (deadline = %.3f secs)"
+                % self.runtimeConfig["collector_update_timeout_secs"]
+            )
+
+    def updateCollectors(self):
+        """Update metrics for all enabled collectors"""
+        if self.__executor:
+            self.updateAllMetricsParallel()
+        else:
+            for collector in self.__collectors:
+                self.updateCollector(collector)
+        return
+
+    def burstSources(self):
+        """Burst sampling sources provided by enabled collectors"""
+        sources = []
+        for collector in self.__collectors:
+            source = collector.burstMetrics()
+            if source is not None:
+                sources.append(source)
+        return sources
 
     def updateAllMetrics(self):
+        """Update all collectors and return text exposition of latest metrics"""
+        self.updateCollectors()
+        return self.render()
+
+    def scrape(self):
+        """Serve /metrics request: concurrent (and recent) scrapes share one update when caching is enabled
+
+        Concurrent requests are serialized: a request that waited on an update already in progress
+        is served the resulting snapshot.
+        """
+        if self.__sampler is not None:
+            return self.__snapshot
+        maxAge = self.runtimeConfig["collector_scrape_cache_secs"]
+        if maxAge <= 0:
+            return self.updateAllMetrics()
+
+        requestTime = time.monotonic()
+        with self.__scrapeLock:
+            if self.__scrapeSnapshot is not None:
+                if self.__scrapeTime >= requestTime or requestTime - self.__scrapeTime < maxAge:
+                    return self.__scrapeSnapshot
+            self.__scrapeSnapshot = self.updateAllMetrics()
+            self.__scrapeTime = time.monotonic()
+            return self.__scrapeSnapshot
+
+    def startSampler(self):
+        """Update collectors from a background thread on aligned deadlines and publish snapshots for scrapes"""
+        interval = self.runtimeConfig["collector_sampling_interval_secs"]
+        self.__samplerTimestamp = Gauge(
+            "omnistat_sampling_timestamp_seconds", "Time of the latest sample published by the background sampler"
+        )
+        self.__samplerOverruns = Counter(
+            "omnistat_sampling_overruns", "Number of samples exceeding the sampling interval"
+        )
+        self.__samplerMissed = Counter("omnistat_sampling_missed_deadlines", "Number of sampling deadlines skipped")
+
+        self.__samplerTimestamp.set(time.time())
+        self.__snapshot = self.render()
+        self.__sampler = threading.Thread(
+            target=self.runSampler, args=(interval,), name="omnistat-sampler", daemon=True
+        )
+        self.__sampler.start()
+        logging.info("Background sampling enabled (interval = %.3f secs)" % interval)
+
+    def runSampler(self, interval_secs):
+        scheduler = DeadlineScheduler(interval_secs)
+        scheduler.start()
+        while True:
+            try:
+                self.updateCollectors()
+                self.__samplerTimestamp.set(time.time())
+                # publish immutable snapshot: scrapes never wait on collector updates
+                self.__snapshot = self.render()
+            except Exception as e:
+                logging.error("[ERROR]: Background sample failed, serving previous snapshot (%s)" % e)
+            skipped = scheduler.wait()
+            if skipped:
+                self.__samplerOverruns.inc()
+                self.__samplerMissed.inc(skipped)
+
+    def render(self):
+        """Text exposition of latest metrics"""
+        return generate_latest()
+
+    def registerCollectorStats(self):
+        """Register self-metrics tracking the update cost of each enabled collector"""
+        self.__collectorStats = {}
+        buckets = (0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0)
+
+        metricName = "omnistat_collector_update_seconds"
+        description = "Time spent in collector updates"
+        self.__collectorStats["duration"] = Histogram(metricName, description, ["collector"], buckets=buckets)
+        logging.info("--> [registered] %s -> %s (histogram)" % (metricName, description))
+
+        metricName = "omnistat_collector_errors"
+        description = "Number of failed collector updates"
+        self.__collectorStats["errors"] = Counter(metricName, description, ["collector"])
+        logging.info("--> [registered] %s -> %s (counter)" % (metricName, description))
+
+        metricName = "omnistat_collector_last_success_timestamp_seconds"
+        description = "Time of last successful collector update"
+        self.__collectorStats["last_success"] = Gauge(metricName, description, ["collector"])
+        logging.info("--> [registered] %s -> %s (gauge)" % (metricName, description))
+
+        # bind per-collector children up front so the update path avoids label lookups
+        self.__collectorStatsChildren = {}
         for collector in self.__collectors:
+            name = type(collector).__name__
+            self.__collectorStatsChildren[collector] = (
+                self.__collectorStats["duration"].labels(collector=name),
+                self.__collectorStats["errors"].labels(collector=name),
+                self.__collectorStats["last_success"].labels(collector=name),
+            )
+        return
+
+    def updateCollector(self, collector):
+        """Update a single collector, tracking update cost when collector stats are enabled"""
+        if self.__collectorStats is None:
             collector.updateMetrics()
-        return generate_latest()
+            return
+
+        duration, errors, last_success = self.__collectorStatsChildren[collector]
+        start_time = time.perf_counter()
+        try:
+            collector.updateMetrics()
+        except Exception:
+            errors.inc()
+            raise
+        finally:
+            duration.observe(time.perf_counter() - start_time)
+        last_success.set(time.time())
+        return
+
+    def updateAllMetricsParallel(self):
+        """Update all collectors concurrently and wait for each of them until the update deadline.
+
+        A collector that misses the deadline keeps running in the background and is not resubmitted
+        until it completes; in the meantime, its metrics continue to hold the last values it set.
+        """
+        deadline = time.perf_counter() + self.runtimeConfig["collector_update_timeout_secs"]
+
+        for collector in self.__collectors:
+            future = self.__pendingUpdates.get(collector)
+            if future is not None:
+                if not future.done():
+                    continue
+                # late completion from an earlier sample
+                self.checkUpdateResult(collector, future)
+            self.__pendingUpdates[collector] = self.__executor.submit(self.updateCollector, collector)
+
+        for collector in self.__collectors:
+            future = self.__pendingUpdates[collector]
+            try:
+                future.result(timeout=max(0.0, deadline - time.perf_counter()))
+            except concurrent.futures.TimeoutError:
+                self.__missedDeadlines[collector] += 1
+                count = self.__missedDeadlines[collector]
+                if count == 1 or count % 100 == 0:
+                    logging.warning(
+                        "[WARN]: %s collector missed update deadline, serving previous values (%i times)"
+                        % (type(collector).__name__, count)
+                    )
+                continue
+            except Exception:
+                pass
+            self.checkUpdateResult(collector, future)
+            del self.__pendingUpdates[collector]
+        return
+
+    def checkUpdateResult(self, collector, future):
+        """Log failures from a completed collector update"""
+        error = future.exception()
+        if error is not None:
+            logging.error("[ERROR]: %s collector failed to update: %s" % (type(collector).__name__, error))
+        return
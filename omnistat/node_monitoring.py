@@ -69,6 +69,7 @@ class OmnistatServer(gunicorn.app.base.BaseApplication):
 def main():
     parser = argparse.ArgumentParser()
     parser.add_argument("--configfile", type=str, help="runtime config file", default=None)
+    parser.add_argument("--startup-profile", help="report time spent in each startup phase", action="store_true")
     args = parser.parse_args()
 
     config = utils.readConfig(utils.findConfigFile(args.configfile))
@@ -92,14 +93,20 @@ def main():
     # Initialize application in the worker after it has been forked to
     # preserve the state of the collectors.
     def post_fork(server, worker):
-        monitor.initMetrics()
-        app.route("/metrics")(lambda: (monitor.updateAllMetrics(), {"Content-Type": "text/plain; charset=utf-8"}))
+        with utils.startupProfile.phase("monitor initialization"):
+            monitor.initMetrics()
+        if args.startup_profile:
+            utils.startupProfile.report()
+        if monitor.runtimeConfig["collector_sampling_mode"] == "background":
+            monitor.startSampler()
+        app.route("/metrics")(lambda: (monitor.scrape(), {"Content-Type": "text/plain; charset=utf-8"}))
         app.route("/shutdown")(shutdown)
 
     listenPort = config["omnistat.collectors"].get("port", 8001)
     options = {
         "bind": "%s:%s" % ("0.0.0.0", listenPort),
         "workers": 1,
+        "threads": config["omnistat.collectors"].getint("scrape_threads", 1),
         "post_fork": post_fork,
     }
 
@@ -0,0 +1,175 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+
+"""Shared scanner for KFD compute unit occupancy
+
+The KFD driver exposes CU occupancy for each process and GPU in
+/sys/class/kfd/kfd/proc/<pid>/stats_<gpu_id>/cu_occupancy. Rather than
+globbing the process tree separately for every GPU on every sample, the
+scanner lists the process directory once per scan and keeps the
+cu_occupancy files of known processes open; new processes are picked up by
+diffing the set of PIDs between scans and exited processes are released.
+Files are re-read with pread() at offset 0, as in SysfsReader.
+
+A single scanner instance is shared by all collectors (see shared()) so that
+GPU totals and per-process values reported in the same period come from
+the same scan.
+"""
+
+import logging
+import os
+import threading
+import time
+
+KFD_PROC = "/sys/class/kfd/kfd/proc"
+
+# scans made within this interval of the previous one are served from the previous results
+SHARED_MAX_AGE_SECS = 0.25
+
+# number of scans between attempts to open missing stats_<gpu_id> entries of known processes
+RETRY_SCANS = 10
+
+_shared = None
+_sharedLock = threading.Lock()
+
+
+def shared(guids):
+    """Return the scanner shared between collectors, tracking (at least) the given KFD gpu_ids"""
+    global _shared
+    with _sharedLock:
+        if _shared is None:
+            _shared = OccupancyScanner(guids)
+        else:
+            _shared.track(guids)
+        return _shared
+
+
+class OccupancyScanner:
+    def __init__(self, guids, base_path=KFD_PROC):
+        """
+        Args:
+            guids (iterable): KFD gpu_ids to track
+            base_path (str): KFD process directory
+        """
+        self.__base = base_path
+        self.__guids = []
+        self.__files = {}
+        self.__missing = {}
+        self.__lock = threading.Lock()
+        self.__scans = 0
+        self.__scanTime = None
+        self.__totals = {}
+        self.__processes = {}
+        self.track(guids)
+
+    def track(self, guids):
+        for guid in guids:
+            if guid not in self.__guids:
+                self.__guids.append(guid)
+                self.__totals[guid] = 0
+                # re-probe known processes for the new GPU on the next scan
+                for pid in self.__files:
+                    self.__missing.setdefault(pid, set()).add(guid)
+
+    @property
+    def totals(self):
+        """CU occupancy summed over all processes, indexed by gpu_id (from the last scan)"""
+        return self.__totals
+
+    @property
+    def processes(self):
+        """Non-zero CU occupancy per process, indexed by pid and then gpu_id (from the last scan)"""
+        return self.__processes
+
+    def scan(self, max_age=0.0):
+        """Refresh occupancy values unless the last scan is less than max_age seconds old"""
+        with self.__lock:
+            now = time.monotonic()
+            if self.__scanTime is not None and now - self.__scanTime < max_age:
+                return self.__totals
+            self.__scanTime = now
+            self.__scans += 1
+
+            try:
+                pids = {entry.name for entry in os.scandir(self.__base) if entry.name.isdigit()}
+            except OSError as e:
+                logging.debug("Unable to list %s (%s)" % (self.__base, e))
+                pids = set()
+
+            for pid in self.__files.keys() - pids:
+                self.release(pid)
+            discovered = pids - self.__files.keys()
+            for pid in discovered:
+                self.__files[pid] = {}
+                self.__missing[pid] = set(self.__guids)
+            if self.__scans % RETRY_SCANS == 0:
+                # processes may start using additional GPUs after they are first seen
+                self.probe(self.__missing)
+            else:
+                self.probe({pid: self.__missing[pid] for pid in discovered})
+
+            totals = dict.fromkeys(self.__guids, 0)
+            processes = {}
+            exited = []
+            for pid, files in self.__files.items():
+                for guid, fd in files.items():
+                    try:
+                        value = int(os.pread(fd, 64, 0))
+                    except (OSError, ValueError):
+                        # process exited (or pid reused) since the directory was listed
+                        exited.append(pid)
+                        break
+                    if value:
+                        totals[guid] += value
+                        processes.setdefault(pid, {})[guid] = value
+            for pid in exited:
+                self.release(pid)
+                processes.pop(pid, None)
+
+            self.__totals = totals
+            self.__processes = processes
+            return totals
+
+    def probe(self, candidates):
+        """Open cu_occupancy files for the given {pid: gpu_ids} not opened so far"""
+        for pid, guids in list(candidates.items()):
+            for guid in list(guids):
+                path = os.path.join(self.__base, pid, "stats_%s" % guid, "cu_occupancy")
+                try:
+                    fd = os.open(path, os.O_RDONLY | os.O_CLOEXEC)
+                except OSError:
+                    continue
+                self.__files[pid][guid] = fd
+                guids.discard(guid)
+
+    def release(self, pid):
+        for fd in self.__files.pop(pid, {}).values():
+            os.close(fd)
+        self.__missing.pop(pid, None)
+
+    def close(self):
+        with self.__lock:
+            for pid in list(self.__files):
+                self.release(pid)
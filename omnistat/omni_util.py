@@ -39,7 +39,10 @@ from pathlib import Path
 
 import yaml
 
-from omnistat import utils
+from omnistat import fanout, utils
+
+# time allowed for exporters to report readiness or shutdown when launched via fan-out
+EXPORTER_TIMEOUT = 120.0
 
 
 class UserBasedMonitoring:
@@ -332,14 +335,18 @@ class UserBasedMonitoring:
                 os.remove("./exporter.log")
             logging.info("[exporter]: Standalone sampling interval = %s" % self.scrape_interval)
             hostname = platform.node().split(".", 1)[0]
+            jobid = os.getenv("SLURM_JOB_ID", os.getenv("FLUX_JOB_ID", os.getenv("PBS_JOBID", "local")))
 
             if self.__external_victoria:
-                cmd = f"nice -n 20 {sys.executable} -m omnistat.standalone --configfile={self.configFile} --interval {self.scrape_interval} --pushinterval {self.push_frequency} --endpoint {self.__external_victoria_endpoint} --port {self.__external_victoria_port} --log exporter.log"
+                cmd = f"nice -n 20 {sys.executable} -m omnistat.standalone --configfile={self.configFile} --interval {self.scrape_interval} --pushinterval {self.push_frequency} --endpoint {self.__external_victoria_endpoint} --port {self.__external_victoria_port} --jobid {jobid} --log exporter.log"
             else:
-                cmd = f"nice -n 20 {sys.executable} -m omnistat.standalone --configfile={self.configFile} --interval {self.scrape_interval} --pushinterval {self.push_frequency} --endpoint {hostname} --log exporter.log"
+                cmd = f"nice -n 20 {sys.executable} -m omnistat.standalone --configfile={self.configFile} --interval {self.scrape_interval} --pushinterval {self.push_frequency} --endpoint {hostname} --jobid {jobid} --log exporter.log"
         else:
             cmd = f"nice -n 20 {sys.executable} -m omnistat.node_monitoring --configfile={self.configFile}"
 
+        if self.runtimeConfig["omnistat.usermode"].getboolean("exporter_startup_profile", False):
+            cmd += " --startup-profile"
+
         logging.debug("[exporter]: %s" % cmd)
 
         if "OMNISTAT_EXPORTER_COREBINDING" in os.environ:
@@ -404,79 +411,73 @@ class UserBasedMonitoring:
                 )
                 time.sleep(1)
 
-            logging.info("Launching exporters in parallel via ssh")
-
             additional_env = ""
             if self.__external_proxy:
                 additional_env = f"http_proxy={self.__external_proxy}"
 
-            # trying local ssh client implementation
-            launch_results = utils.execute_ssh_parallel(
-                command=f"sh -c 'cd {os.getcwd()} && PYTHONPATH={':'.join(sys.path)} {additional_env} {cmd}'",
-                hostnames=self.__hosts,
-                max_concurrent=128,
-                ssh_timeout=100,
-                max_retries=3,
-                retry_delay=5,
-            )
-
-            # verify exporter available on all nodes...
-            if len(self.__hosts) <= 8:
-                psecs = 5
-            elif len(self.__hosts) <= 128:
-                psecs = 30
+            command = f"cd {os.getcwd()} && PYTHONPATH={':'.join(sys.path)} {additional_env} {cmd}"
+            launcher = self.exporterLauncher()
+
+            if launcher == "rms":
+                hosts_ok, hosts_bad = self.launchExportersStep(command, port)
+            elif launcher == "tree":
+                degree = self.runtimeConfig["omnistat.usermode"].getint("exporter_fanout", 32)
+                logging.info("Launching exporters via ssh fan-out tree (degree = %i)" % degree)
+                tree = fanout.FanoutLauncher("launch", command, port, degree, timeout=EXPORTER_TIMEOUT)
+                results = tree.run(self.__hosts)
+                hosts_ok = results["ok"]
+                hosts_bad = results["failed"]
             else:
-                psecs = 90
+                logging.info("Launching exporters in parallel via ssh")
 
-            logging.info("Exporters launched, pausing for %i secs" % psecs)
-            time.sleep(psecs)  # <-- needed for slow SLURM query times on ORNL
-            numHosts = len(self.__hosts)
-            numAvail = 0
+                # trying local ssh client implementation
+                launch_results = utils.execute_ssh_parallel(
+                    command=f"sh -c '{command}'",
+                    hostnames=self.__hosts,
+                    max_concurrent=128,
+                    ssh_timeout=100,
+                    max_retries=3,
+                    retry_delay=5,
+                )
+
+                # verify exporter available on all nodes...
+                if len(self.__hosts) <= 8:
+                    psecs = 5
+                elif len(self.__hosts) <= 128:
+                    psecs = 30
+                else:
+                    psecs = 90
+
+                logging.info("Exporters launched, pausing for %i secs" % psecs)
+                time.sleep(psecs)  # <-- needed for slow SLURM query times on ORNL
 
-            if True:
                 logging.info("Testing exporter availability")
-                delay_start = 0.05
                 hosts_ok = []
                 hosts_bad = []
-                for host in self.__hosts:
-                    host_ok = False
-                    for iter in range(1, 25):
-                        with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
-                            try:
-                                result = s.connect_ex((host, int(port)))
-
-                                if result == 0:
-                                    numAvail = numAvail + 1
-                                    hosts_ok.append(host)
-                                    logging.debug("Exporter on %s ok" % host)
-                                    host_ok = True
-                                    break
-                                else:
-                                    delay = delay_start * iter
-                                    logging.debug("Retrying %s (sleeping for %.2f sec)" % (host, delay))
-                                    time.sleep(delay)
-                                s.close()
-                            except Exception as e:
-                                break
-
-                    if not host_ok:
-                        logging.error("Missing exporter on %s (%s)" % (host, result))
-                        hosts_bad.append(host)
-
-                logging.info("%i of %i exporters available" % (numAvail, numHosts))
-                if numAvail == numHosts:
-                    logging.info("User mode data collectors: SUCCESS")
-
-                # cache any failed hosts to file
-                jobid = os.getenv("SLURM_JOB_ID", None)
-                if jobid:
-                    fileout = "omnistat_failed_hosts.%s.out" % jobid
-                    if hosts_bad:
-                        with open(fileout, "w") as f:
-                            for host in hosts_bad:
-                                f.write(host + "\n")
-                        f.close()
-                        logging.info("Cached failed startup hosts in %s" % fileout)
+                with concurrent.futures.ThreadPoolExecutor(max_workers=256) as executor:
+                    available = executor.map(lambda host: self.checkExporter(host, port), self.__hosts)
+                    for host, host_ok in zip(self.__hosts, available):
+                        (hosts_ok if host_ok else hosts_bad).append(host)
+
+            for host in hosts_bad:
+                logging.error("Missing exporter on %s" % host)
+
+            numHosts = len(self.__hosts)
+            numAvail = len(hosts_ok)
+            logging.info("%i of %i exporters available" % (numAvail, numHosts))
+            if numAvail == numHosts:
+                logging.info("User mode data collectors: SUCCESS")
+
+            # cache any failed hosts to file
+            jobid = os.getenv("SLURM_JOB_ID", None)
+            if jobid:
+                fileout = "omnistat_failed_hosts.%s.out" % jobid
+                if hosts_bad:
+                    with open(fileout, "w") as f:
+                        for host in hosts_bad:
+                            f.write(host + "\n")
+                    f.close()
+                    logging.info("Cached failed startup hosts in %s" % fileout)
 
         return
 
@@ -497,6 +498,23 @@ class UserBasedMonitoring:
         logging.info("Stopping %i exporters" % len(self.__hosts))
 
         port = self.runtimeConfig["omnistat.collectors"].get("port", "8001")
+        launcher = self.exporterLauncher()
+
+        if launcher in ["rms", "tree"]:
+            t1 = time.perf_counter()
+            if launcher == "rms":
+                hosts_ok, hosts_bad = self.stopExportersStep(port)
+            else:
+                degree = self.runtimeConfig["omnistat.usermode"].getint("exporter_fanout", 32)
+                tree = fanout.FanoutLauncher("shutdown", port=port, degree=degree, timeout=EXPORTER_TIMEOUT)
+                results = tree.run(self.__hosts)
+                hosts_ok = results["ok"]
+                hosts_bad = results["failed"]
+            t2 = time.perf_counter()
+            for host in hosts_bad:
+                logging.warning("[WARN]: Unable to confirm exporter shutdown on %s" % host)
+            logging.info("--> %i of %i exporters stopped in %.2f secs" % (len(hosts_ok), len(self.__hosts), t2 - t1))
+            return
 
         with concurrent.futures.ThreadPoolExecutor(max_workers=256) as executor:
             future_to_host = {
@@ -531,6 +549,84 @@ class UserBasedMonitoring:
 
         return
 
+    def exporterLauncher(self):
+        """Determine mechanism used to start and stop exporters (ssh, tree, or rms)"""
+        launcher = self.runtimeConfig["omnistat.usermode"].get("exporter_launcher", "ssh")
+        if launcher not in ["ssh", "tree", "rms"]:
+            utils.error("Unsupported exporter_launcher setting (%s); expecting ssh, tree, or rms" % launcher)
+        if launcher == "rms" and self.__rms not in ["slurm", "flux"]:
+            logging.info("[exporter]: Job steps not supported with %s RMS, using ssh fan-out tree" % self.__rms)
+            launcher = "tree"
+        return launcher
+
+    def stepCommand(self, action, port, command=None):
+        """Single job step (srun/flux exec) running omnistat.fanout on every assigned host"""
+        if self.__rms == "slurm":
+            numNodes = os.getenv("SLURM_JOB_NUM_NODES")
+            step = ["srun", "--overlap", "-N %s" % numNodes, "--ntasks-per-node=1", "--job-name=omnistat-%s" % action]
+        else:
+            step = ["flux", "exec"]
+        step += ["env", f"PYTHONPATH={':'.join(sys.path)}", sys.executable, "-m", "omnistat.fanout"]
+        step += ["--action", action, "--port", str(port), "--timeout", "%.1f" % EXPORTER_TIMEOUT]
+        if command:
+            step += ["--command", command]
+        return step
+
+    def stepResults(self, output, ack):
+        """Match per-host acknowledgements from a job step against assigned hosts"""
+        acked = set()
+        for line in output.splitlines():
+            fields = line.split()
+            if len(fields) == 2 and fields[0] == ack:
+                acked.add(fields[1].split(".", 1)[0])
+        hosts_ok = [host for host in self.__hosts if host.split(".", 1)[0] in acked]
+        hosts_bad = [host for host in self.__hosts if host.split(".", 1)[0] not in acked]
+        return hosts_ok, hosts_bad
+
+    def launchExportersStep(self, command, port):
+        """Launch exporters as a single background job step and wait for readiness acknowledgements"""
+        jobid = os.getenv("SLURM_JOB_ID", os.getenv("FLUX_JOB_ID", "local"))
+        logfile = os.path.join(tempfile.gettempdir(), "omnistat_exporters.%s.log" % jobid)
+        step = self.stepCommand("run", port, command)
+        logging.info("Launching exporters via single %s step" % step[0])
+        logging.debug("[exporter]: %s" % step)
+        process = utils.runBGProcess(step, outputFile=logfile)
+
+        numHosts = len(self.__hosts)
+        deadline = time.monotonic() + EXPORTER_TIMEOUT
+        while True:
+            with open(logfile) as f:
+                output = f.read()
+            acks = output.count(fanout.READY) + output.count(fanout.FAILED)
+            if acks >= numHosts or process.poll() is not None or time.monotonic() >= deadline:
+                break
+            time.sleep(0.5)
+
+        return self.stepResults(output, fanout.READY)
+
+    def stopExportersStep(self, port):
+        """Shut down exporters via a single job step"""
+        step = self.stepCommand("stop", port)
+        results = utils.runShellCommand(step, timeout=EXPORTER_TIMEOUT + 30)
+        return self.stepResults(results.stdout if results else "", fanout.STOPPED)
+
+    def checkExporter(self, host, port):
+        """Test exporter availability on host, retrying with increasing delays"""
+        delay_start = 0.05
+        for iter in range(1, 25):
+            with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
+                try:
+                    result = s.connect_ex((host, int(port)))
+                except Exception as e:
+                    return False
+            if result == 0:
+                logging.debug("Exporter on %s ok" % host)
+                return True
+            delay = delay_start * iter
+            logging.debug("Retrying %s (sleeping for %.2f sec)" % (host, delay))
+            time.sleep(delay)
+        return False
+
     def verifyNumaCommand(self, coreid):
         """Verify numactl is available and works with supplied core id when provided
 
@@ -24,12 +24,19 @@
 # -------------------------------------------------------------------------------
 
 import argparse
+import collections
+import hashlib
+import json
 import logging
+import math
 import os
+import re
 import shutil
 import subprocess
 import sys
+import threading
 import timeit
+from concurrent.futures import ThreadPoolExecutor
 from datetime import datetime, timedelta
 from pathlib import Path
 from string import Template
@@ -82,9 +89,11 @@ from omnistat import utils
 #     ---------------------------------------------------------------------
 #    Note that the maximum job duration is not a hard constraint: 1) the query
 #    tool can still be used with intervals longer than the sampling interval,
-#    and 2) Victoria Metrics can be tweaked to support longer job durations by
+#    2) Victoria Metrics can be tweaked to support longer job durations by
 #    increasing the `-search.maxPointsPerTimeseries` setting, which is 30k by
-#    default and automatically bumped up to 90k in usermode Omnistat.
+#    default and automatically bumped up to 90k in usermode Omnistat, and 3)
+#    longer ranges are split into multiple queries of up to
+#    `max_points_per_query` points (30k by default).
 class QueryMetrics:
 
     # Minimum number of samples required to process data and generate reports.
@@ -131,9 +140,32 @@ class QueryMetrics:
         self.config = {}
         self.config["system_name"] = config["omnistat.query"].get("system_name", "My Snazzy Cluster")
         self.config["prometheus_url"] = config["omnistat.query"].get("prometheus_url", "http://localhost:9090")
+        self.config["max_concurrent_queries"] = config["omnistat.query"].getint("max_concurrent_queries", 8)
+        self.config["cache_dir"] = config["omnistat.query"].get("cache_dir", None)
+        self.config["max_points_per_query"] = config["omnistat.query"].getint("max_points_per_query", 30000)
+        self.config["max_hosts_per_query"] = config["omnistat.query"].getint("max_hosts_per_query", 128)
+        self.config["max_memo_points"] = config["omnistat.query"].getint("max_memo_points", 2000000)
+        self.config["server_side_aggregation"] = config["omnistat.query"].getboolean("server_side_aggregation", False)
+        self.config["job_index"] = config["omnistat.query"].get("job_index", None)
 
         self.prometheus = PrometheusConnect(url=self.config["prometheus_url"])
 
+        # Independent job range queries are issued concurrently, and recent
+        # responses are memoized (and optionally cached on disk) so that
+        # queries shared between the report and exports are requested only
+        # once. The memo is an LRU bounded to max_memo_points samples.
+        self.query_executor = ThreadPoolExecutor(max_workers=max(1, self.config["max_concurrent_queries"]))
+        # Long or wide queries are split into time chunks and host shards,
+        # requested with a separate pool (queries may be split from within
+        # query_executor workers).
+        self.chunk_executor = ThreadPoolExecutor(max_workers=max(1, self.config["max_concurrent_queries"]))
+        self.query_memo = collections.OrderedDict()
+        self.query_memo_points = 0
+        self.query_memo_lock = threading.Lock()
+        if self.config["cache_dir"]:
+            self.config["cache_dir"] = os.path.expanduser(self.config["cache_dir"])
+            os.makedirs(self.config["cache_dir"], exist_ok=True)
+
         self.enable_redirect = False
         self.vendorData = False
         self.output = None
@@ -159,6 +191,8 @@ class QueryMetrics:
         self.num_gpus = None
         self.start_time = None
         self.end_time = None
+        # Accuracy of the estimated start/end times, in seconds
+        self.range_accuracy = QueryMetrics.SCAN_STEP
 
         self.hosts = None
 
@@ -169,12 +203,13 @@ class QueryMetrics:
             self.output.close()
 
     def find_job_info(self):
-        self._estimate_range()
+        if not self._indexed_range():
+            self._estimate_range()
         if not self.start_time:
             print("[ERROR]: no monitoring data found for job=%s" % self.jobID)
             sys.exit(1)
 
-        if self.interval < QueryMetrics.SCAN_STEP:
+        if self.interval < self.range_accuracy:
             self._refine_range()
 
         # NOOP if job is very short running
@@ -188,6 +223,39 @@ class QueryMetrics:
         self._retrieve_info()
         self._retrieve_hosts()
 
+    def _indexed_range(self):
+        """
+        Look up the time range of the job in a persisted job index (generated
+        by omnistat-index, see docker/index.py) to avoid scanning the
+        database. Jobs that may have still been running when the index was
+        last updated, and queries for a job step, fall back to scanning.
+
+        Returns:
+            bool: True if start_time and end_time were set from the index
+        """
+        index_file = self.config["job_index"]
+        if not index_file or self.jobStep:
+            return False
+
+        try:
+            with open(os.path.expanduser(index_file), "r") as f:
+                index = json.load(f)
+            job = index["jobs"].get(str(self.jobID))
+            step = index["step"]
+            scanned_until = index["scanned_until"]
+        except (OSError, ValueError, KeyError, TypeError) as e:
+            logging.warning("[WARNING]: ignoring unreadable job index %s (%s)" % (index_file, e))
+            return False
+
+        if job is None or scanned_until is None or scanned_until - job["end"] < 2 * step:
+            return False
+
+        self.start_time = datetime.fromtimestamp(job["start"])
+        self.end_time = datetime.fromtimestamp(job["end"])
+        self.range_accuracy = step
+        logging.debug("Job range found in index -> %s to %s" % (self.start_time, self.end_time))
+        return True
+
     def _estimate_range(self):
         """
         Scan the last SCAN_DAYS days, one day at a time, attempting to find
@@ -352,6 +420,15 @@ class QueryMetrics:
         return minindex, sum
 
     def gather_vendor_data(self):
+        # request all vendor data concurrently; subsequent queries are served from memoized results
+        vendor_metrics = [
+            "omnistat_vendor_energy_joules",
+            "omnistat_vendor_memory_energy_joules",
+            "omnistat_vendor_cpu_energy_joules",
+        ]
+        vendor_metrics += [f'omnistat_vendor_accel_energy_joules{{card="{gpu}"}}' for gpu in range(self.num_gpus)]
+        self.query_job_ranges([self.job_query(metric) for metric in vendor_metrics], shard_hosts=True)
+
         # node-level data: total energy usage
         times_raw, values_raw, hosts = self.query_time_series_data("omnistat_vendor_energy_joules")
         if not values_raw:
@@ -419,7 +496,7 @@ class QueryMetrics:
 
         return
 
-    def gather_data(self, saveTimeSeries=False):
+    def reset_stats(self):
         self.stats = {}
         self.time_series = {}
         self.max_GPU_memory_avail = []
@@ -429,11 +506,113 @@ class QueryMetrics:
 
         for entry in QueryMetrics.METRICS:
             metric = entry["metric"]
-
             self.stats[metric + "_min"] = []
             self.stats[metric + "_max"] = []
             self.stats[metric + "_mean"] = []
 
+    def gather_data(self, saveTimeSeries=False):
+        if self.config["server_side_aggregation"]:
+            try:
+                self.gather_aggregated_data(saveTimeSeries)
+                return
+            except Exception as e:
+                logging.warning("[WARNING]: unable to aggregate report data on server (%s)" % e)
+                logging.warning("--> retrieving raw time series instead")
+
+        self.gather_raw_data(saveTimeSeries)
+
+    def gather_aggregated_data(self, saveTimeSeries=False):
+        """
+        Compute report statistics with MetricsQL rollups over the job's range,
+        returning one value per host and GPU rather than full time series:
+         - max value: max_over_time() per series, reduced by card
+         - mean value: avg_over_time() per series (also per-GPU means)
+         - energy: integrate() of power per series
+        Time series for plots are reduced to one series per card.
+        """
+        self.reset_stats()
+
+        # rollup windows are left-open: extend by 1ms so that the window starts at (and includes) start_time
+        duration = (self.end_time - self.start_time).total_seconds()
+        window = "%ims" % (math.ceil(duration * 1000) + 1)
+        job = "* on (instance) group_left() (max by (instance) (last_over_time(rmsjob_info{$job,$step}[%s])))" % window
+
+        # data rolled up on-node (rollup_secs) provides per-window extrema and cumulative energy
+        # series, which are preferred over the (mean) source series when present
+        power = "rocm_average_socket_power_watts"
+        metrics = [entry["metric"] for entry in QueryMetrics.METRICS]
+        queries = {}
+        for metric in metrics:
+            peak = "(max_over_time(%s_max[%s]) or max_over_time(%s[%s]))" % (metric, window, metric, window)
+            queries[(metric, "max")] = "max by (card) (%s %s)" % (peak, job)
+            queries[(metric, "mean")] = "avg_over_time(%s[%s]) %s" % (metric, window, job)
+        energy = "rocm_average_socket_power_energy_joules"
+        energy = "(increase(%s[%s]) or integrate(%s[%s]))" % (energy, window, power, window)
+        queries[("energy", None)] = "%s %s" % (energy, job)
+        results = dict(zip(queries, self.query_job_instants(list(queries.values()))))
+
+        if saveTimeSeries:
+            series = self.query_job_ranges(["avg by (card) (%s)" % self.job_series_query(metric) for metric in metrics])
+            series = dict(zip(metrics, series))
+
+        for metric in metrics:
+            max_per_card = {}
+            for result in results[(metric, "max")]:
+                max_per_card[result["metric"].get("card")] = float(result["value"][1])
+            means_per_card = {}
+            for result in results[(metric, "mean")]:
+                means_per_card.setdefault(result["metric"].get("card"), []).append(float(result["value"][1]))
+
+            if saveTimeSeries:
+                self.time_series[metric] = []
+                series_per_card = self.split_series_by_card(series[metric])
+
+            for gpu in range(self.num_gpus):
+                card = str(gpu)
+                if card not in max_per_card or card not in means_per_card:
+                    raise LookupError('no data for %s{card="%s"}' % (metric, card))
+
+                self.stats[metric + "_max"].append(max_per_card[card])
+                self.stats[metric + "_mean"].append(np.mean(means_per_card[card]))
+
+                # save mean utilization per individual gpu
+                if metric == "rocm_utilization_percentage":
+                    self.mean_util_per_gpu[gpu] = means_per_card[card]
+
+                if saveTimeSeries:
+                    times, values, hosts = series_per_card[card]
+                    self.time_series[metric].append({"time": times[0], "values": values[0]})
+
+        # Sum total energy across all hosts and gpus
+        energy_per_card = {}
+        for result in results[("energy", None)]:
+            # Units: W x [sec] = Joules -> Convert to kWH
+            energy = float(result["value"][1]) / (1000 * 3600)
+            energy_per_card.setdefault(result["metric"].get("card"), []).append(energy)
+        for gpu in range(self.num_gpus):
+            if str(gpu) not in energy_per_card:
+                raise LookupError('no energy data for card="%i"' % gpu)
+            energy_per_host = energy_per_card[str(gpu)]
+            self.gpu_energy_total_kwh += sum(energy_per_host)
+            self.energyStats_kwh[gpu] = energy_per_host
+
+        return
+
+    def gather_raw_data(self, saveTimeSeries=False):
+        self.reset_stats()
+
+        # data rolled up on-node (rollup_secs) stores window means in the source series: per-window
+        # extrema and cumulative energy series are preferred for maxima and energy when present
+        energy = "rocm_average_socket_power_energy_joules"
+        metrics = [entry["metric"] for entry in QueryMetrics.METRICS]
+        series = metrics + [metric + "_max" for metric in metrics] + [energy]
+        queries = [self.job_series_query(metric) for metric in series]
+        results = dict(zip(series, self.query_job_ranges(queries, shard_hosts=True)))
+        energy_per_card = self.split_series_by_card(results[energy])
+
+        for entry in QueryMetrics.METRICS:
+            metric = entry["metric"]
+
             if saveTimeSeries:
                 self.time_series[metric] = []
                 self.time_series[metric + "_hostmax_raw"] = []
@@ -443,38 +622,41 @@ class QueryMetrics:
             # minValue =  sys.float_info.max
             # maxValue = -sys.float_info.max
 
+            # raw time series for all cards and hosts are requested with a single query
+            try:
+                series_per_card = self.split_series_by_card(results[metric])
+                max_per_card = self.split_series_by_card(results[metric + "_max"])
+            except:
+                utils.error("Unable to query prometheus data for metric -> %s" % metric)
+
             for gpu in range(self.num_gpus):
 
-                query_metric = f'{metric}{{card="{gpu}"}}'
-                try:
-                    # (1) capture time series that assembles [mean] value at each timestamp across all assigned nodes
-                    times, values_mean = self.query_time_series_data(query_metric, "avg")
+                if str(gpu) not in series_per_card:
+                    utils.error('Unable to query prometheus data for metric -> %s{card="%i"}' % (metric, gpu))
 
-                    # (2) capture time series that assembles [max] value at each timestamp across all assigned nodes
-                    times, values_max = self.query_time_series_data(query_metric, "max")
+                # (1) capture raw time series
+                times_raw, values_raw, hosts = series_per_card[str(gpu)]
 
-                    # (3) capture raw time series
-                    times_raw, values_raw, hosts = self.query_time_series_data(query_metric)
-                except:
-                    utils.error("Unable to query prometheus data for metric -> %s" % query_metric)
+                # (2) assemble [mean] and [max] values at each timestamp across all assigned nodes
+                times, values_mean, values_max = self.reduce_time_series(times_raw, values_raw)
 
                 # Sum total energy across all hosts and gpus
                 if metric == "rocm_average_socket_power_watts":
                     energy_per_host = []
-
-                    energyTotal = 0.0
-                    for i in range(len(times_raw)):
-                        startDate = times_raw[i][0]
-                        x = (times_raw[i] - startDate).astype("timedelta64[s]").astype(float)
-                        # Integrate time series to get energy used on this host/gpu index
+                    if str(gpu) in energy_per_card:
+                        # Increase of cumulative energy on each host for this gpu index
+                        # Units: Joules -> Convert to kWH
+                        for values in energy_per_card[str(gpu)][1]:
+                            energy_per_host.append((values[-1] - values[0]) / (1000 * 3600))
+                    else:
+                        # Integrate time series to get energy used on each host for this gpu index
                         # Units: W x [sec] = Joules -> Convert to kWH
-                        energy = np.trapezoid(values_raw[i], x=x) / (1000 * 3600)
-                        # accumulate to get total energy used by all hosts with this gpu index
-                        energyTotal += energy
-                        energy_per_host.append(energy)
+                        for i in range(len(times_raw)):
+                            x = (times_raw[i] - times_raw[i][0]) / np.timedelta64(1, "s")
+                            energy_per_host.append(np.trapezoid(values_raw[i], x=x) / (1000 * 3600))
 
                     # total energy used by this gpu index across all hosts
-                    self.gpu_energy_total_kwh += energyTotal
+                    self.gpu_energy_total_kwh += sum(energy_per_host)
                     self.energyStats_kwh[gpu] = energy_per_host
 
                 # # Track hosts with min/max area under the curve (across all GPUs)
@@ -487,7 +669,10 @@ class QueryMetrics:
                 #         print("%s %s %s" % (times[i],values_mean[i], values_max[i]))
                 # sys.exit(1)
 
-                self.stats[metric + "_max"].append(np.max(values_max))
+                peak = np.max(values_max)
+                if str(gpu) in max_per_card:
+                    peak = max(peak, max(np.max(values) for values in max_per_card[str(gpu)][1]))
+                self.stats[metric + "_max"].append(peak)
                 self.stats[metric + "_mean"].append(np.mean(values_mean))
 
                 if metric == "rocm_vram_used":
@@ -509,12 +694,8 @@ class QueryMetrics:
                     values_max = 100.0 * values_max / memoryAvail
 
                 # save mean utilization per individual gpu
-                values = []
-                if metric == "rocm_utilization":
-                    for i in range(len(times_raw)):
-                        mean = np.mean(values_raw[i])
-                        values.append(mean)
-                    self.mean_util_per_gpu[gpu] = values
+                if metric == "rocm_utilization_percentage":
+                    self.mean_util_per_gpu[gpu] = [np.mean(values) for values in values_raw]
 
                 if saveTimeSeries:
                     self.time_series[metric].append({"time": times, "values": values_mean})
@@ -611,30 +792,144 @@ class QueryMetrics:
         print("Version = %s" % self.version)
         return
 
-    def query_range(self, query_template, start, end, step, lookback=None):
+    def query_range(self, query_template, start, end, step, lookback=None, hosts=None):
         """
         Request a given query in the provided range. The query may optionally
         include variables to select job ID ($job) and step ID ($step) labels,
         and which are automatically substituted for the appropriate value.
 
+        Ranges with more than max_points_per_query points per series are
+        split into consecutive time chunks (see query_range_chunks), which
+        are merged in order as they are received.
+
         Args:
             query_template (str): PromQL query with substitutions.
             start (datetime): Query start time.
             end (datetime): Query end time.
             step (str|float): Query resolution string with unit, or float in seconds.
+            hosts (list): Optionally restrict job info ($step) to the given instances.
 
         Result:
             dict: Metric data in response of the submitted query.
         """
+        return self.merge_results(self.query_range_chunks(query_template, start, end, step, lookback, hosts))
+
+    def query_range_chunks(self, query_template, start, end, step, lookback=None, hosts=None):
+        """
+        Generator providing responses for consecutive time chunks of a range
+        query (see query_range for arguments), in order. Chunks are requested
+        concurrently, with at most max_concurrent_queries chunks requested
+        ahead of the one being consumed, so memory is bounded regardless of
+        the length of the range.
+        """
         template = Template(query_template)
         params = {}
         if lookback:
             params = {"max_lookback": lookback}
-        query = template.substitute(job=f'jobid="{self.jobID}"', step=self.jobstepQuery)
-        results = self.prometheus.custom_query_range(query, start, end, step=step, params=params)
-        return results
+        step_query = self.jobstepQuery
+        if hosts:
+            # host names are matched as literals (e.g. dots in FQDNs), escaped for a PromQL string
+            pattern = "|".join(re.escape(host) for host in hosts)
+            step_query += ',instance=~"%s"' % pattern.replace("\\", "\\\\")
+        query = template.substitute(job=f'jobid="{self.jobID}"', step=step_query)
+
+        chunks = self.time_chunks(start, end, step)
+        if len(chunks) == 1:
+            yield self.prometheus.custom_query_range(query, start, end, step=step, params=params)
+            return
+
+        logging.debug("Splitting query into %i time chunks -> %s" % (len(chunks), query))
+        max_pending = max(1, self.config["max_concurrent_queries"])
+        pending = collections.deque()
+        for chunk_start, chunk_end in chunks:
+            pending.append(
+                self.chunk_executor.submit(
+                    self.prometheus.custom_query_range, query, chunk_start, chunk_end, step=step, params=params
+                )
+            )
+            if len(pending) >= max_pending:
+                yield pending.popleft().result()
+        while pending:
+            yield pending.popleft().result()
+
+    def time_chunks(self, start, end, step):
+        """
+        Split a range into consecutive chunks with at most max_points_per_query
+        points each. Chunks are aligned to the step so that no evaluation
+        timestamps are repeated or skipped.
 
-    def query_job_range(self, query_template):
+        Result:
+            list: (start, end) tuples.
+        """
+        max_points = self.config["max_points_per_query"]
+        if isinstance(step, str) or max_points <= 0:
+            return [(start, end)]
+
+        points = int((end - start).total_seconds() / step) + 1
+        if points <= max_points:
+            return [(start, end)]
+
+        chunks = []
+        chunk_start = start
+        while chunk_start <= end:
+            chunk_end = min(chunk_start + timedelta(seconds=step * (max_points - 1)), end)
+            chunks.append((chunk_start, chunk_end))
+            chunk_start = chunk_end + timedelta(seconds=step)
+        return chunks
+
+    def merge_results(self, responses):
+        """
+        Merge results from multiple queries, concatenating values of series
+        with identical labels. Responses are consumed one at a time, in order,
+        and merged into the output as they are received (each response can be
+        released once merged). Samples repeated at chunk boundaries (at or
+        before the last merged timestamp of a series) are dropped.
+        """
+        merged = {}
+        for response in responses:
+            for result in response:
+                key = tuple(sorted(result["metric"].items()))
+                if key in merged:
+                    values = merged[key]["values"]
+                    last = values[-1][0] if values else None
+                    for value in result["values"]:
+                        if last is None or value[0] > last:
+                            values.append(value)
+                else:
+                    merged[key] = result
+        return list(merged.values())
+
+    def memo_get(self, key):
+        """Memoized response for a query key (None if not memoized)"""
+        with self.query_memo_lock:
+            entry = self.query_memo.get(key)
+            if entry is None:
+                return None
+            self.query_memo.move_to_end(key)
+            return entry[0]
+
+    def memo_put(self, key, results):
+        """Memoize a query response, evicting least recently used responses beyond max_memo_points samples"""
+        points = sum(len(result["values"]) if "values" in result else 1 for result in results)
+        if points > self.config["max_memo_points"]:
+            return
+        with self.query_memo_lock:
+            if key in self.query_memo:
+                self.query_memo_points -= self.query_memo.pop(key)[1]
+            self.query_memo[key] = (results, points)
+            self.query_memo_points += points
+            while self.query_memo_points > self.config["max_memo_points"]:
+                _, (_, evicted) = self.query_memo.popitem(last=False)
+                self.query_memo_points -= evicted
+
+    def host_shards(self):
+        """Split job hosts into subsets of at most max_hosts_per_query hosts"""
+        max_hosts = self.config["max_hosts_per_query"]
+        if not self.hosts or max_hosts <= 0 or len(self.hosts) <= max_hosts:
+            return [None]
+        return [self.hosts[i : i + max_hosts] for i in range(0, len(self.hosts), max_hosts)]
+
+    def query_job_range(self, query_template, shard_hosts=False):
         """
         Request a given query in the job's range. The query may optionally
         include variables to select job ID ($job) and step ID ($step) labels,
@@ -642,6 +937,8 @@ class QueryMetrics:
 
         Args:
             query_template (str): PromQL query with substitutions.
+            shard_hosts (bool): Split query into host subsets (for queries
+                that do not aggregate across hosts).
 
         Result:
             dict: Metric data in response of the submitted query.
@@ -653,17 +950,181 @@ class QueryMetrics:
         # consistent results and avoid NaNs.
         slowest_sample_seconds = 0.3
         lookback = self.interval + slowest_sample_seconds
-        results = self.query_range(query_template, self.start_time, self.end_time, self.interval, lookback)
+
+        key = (query_template, self.start_time, self.end_time, self.interval, lookback)
+        results = self.memo_get(key)
+        if results is not None:
+            return results
+
+        results = self.read_query_cache(key)
+        if results is None:
+            shards = self.host_shards() if shard_hosts else [None]
+            if len(shards) == 1:
+                results = self.query_range(query_template, self.start_time, self.end_time, self.interval, lookback)
+            else:
+                results = []
+                for hosts in shards:
+                    results += self.query_range(
+                        query_template, self.start_time, self.end_time, self.interval, lookback, hosts
+                    )
+            self.write_query_cache(key, results)
+
+        self.memo_put(key, results)
         return results
 
-    def query_time_series_data(self, metric_name, reducer=None, dataType=float):
+    def query_job_range_chunks(self, query_template, shard_hosts=False):
+        """
+        Generator providing the response of a query in the job's range (see
+        query_job_range) in parts, one host shard and time chunk at a time,
+        for consumers that process series incrementally. Memoized or cached
+        responses are provided as a single part; other parts are not
+        memoized, so each can be released once processed.
+        """
+        slowest_sample_seconds = 0.3
+        lookback = self.interval + slowest_sample_seconds
+
+        key = (query_template, self.start_time, self.end_time, self.interval, lookback)
+        results = self.memo_get(key)
+        if results is None:
+            results = self.read_query_cache(key)
+        if results is not None:
+            yield results
+            return
+
+        for hosts in self.host_shards() if shard_hosts else [None]:
+            yield from self.query_range_chunks(
+                query_template, self.start_time, self.end_time, self.interval, lookback, hosts
+            )
+
+    def query_job_instant(self, query_template):
+        """
+        Request a given instant query evaluated at the end of the job's range
+        (e.g. rollups over the job duration). The query may optionally include
+        variables to select job ID ($job) and step ID ($step) labels.
+
+        Args:
+            query_template (str): PromQL query with substitutions.
+
+        Result:
+            list: Instant vector in response of the submitted query.
+        """
+        key = ("instant:" + query_template, self.start_time, self.end_time, None, None)
+        results = self.memo_get(key)
+        if results is not None:
+            return results
+
+        results = self.read_query_cache(key)
+        if results is None:
+            template = Template(query_template)
+            query = template.substitute(job=f'jobid="{self.jobID}"', step=self.jobstepQuery)
+            results = self.prometheus.custom_query(query, params={"time": self.end_time.timestamp()})
+            self.write_query_cache(key, results)
+
+        self.memo_put(key, results)
+        return results
+
+    def query_job_instants(self, query_templates):
+        """Request multiple independent instant queries concurrently"""
+        return list(self.query_executor.map(self.query_job_instant, query_templates))
 
+    def query_job_ranges(self, query_templates, shard_hosts=False):
+        """
+        Request multiple independent queries in the job's range concurrently.
+
+        Args:
+            query_templates (list): PromQL queries with substitutions.
+            shard_hosts (bool): Split queries into host subsets.
+
+        Result:
+            list: Metric data in response of each submitted query.
+        """
+        return list(self.query_executor.map(lambda query: self.query_job_range(query, shard_hosts), query_templates))
+
+    def query_cache_file(self, key):
+        """Path of on-disk cache entry for a job range query (None if caching is disabled)"""
+        if not self.config["cache_dir"]:
+            return None
+        query_template, start, end, step, lookback = key
+        entry = "|".join(
+            [self.config["prometheus_url"], query_template, self.jobstepQuery, start.isoformat(), end.isoformat()]
+            + [str(step), str(lookback)]
+        )
+        digest = hashlib.sha256(entry.encode()).hexdigest()[:32]
+        return os.path.join(self.config["cache_dir"], f"{self.jobID}-{digest}.json")
+
+    def read_query_cache(self, key):
+        cache_file = self.query_cache_file(key)
+        if cache_file is None or not os.path.isfile(cache_file):
+            return None
+        try:
+            with open(cache_file, "r") as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            logging.warning("[WARNING]: ignoring unreadable query cache entry %s" % cache_file)
+            return None
+
+    def write_query_cache(self, key, results):
+        cache_file = self.query_cache_file(key)
+        if cache_file is None:
+            return
+        with open(cache_file + ".tmp", "w") as f:
+            json.dump(results, f)
+        os.replace(cache_file + ".tmp", cache_file)
+
+    def job_query(self, metric_name, reducer=None):
+        """Query template for metric data restricted to the hosts and time range of the job"""
         if reducer is None:
-            query = "%s * on (instance) (max by (instance) (rmsjob_info{$job,$step}))" % (metric_name)
-            results = self.query_job_range(query)
-        else:
-            query = "%s(%s * on (instance) (max by (instance) (rmsjob_info{$job,$step})))" % (reducer, metric_name)
-            results = self.query_job_range(query)
+            return "%s * on (instance) (max by (instance) (rmsjob_info{$job,$step}))" % (metric_name)
+        return "%s(%s * on (instance) (max by (instance) (rmsjob_info{$job,$step})))" % (reducer, metric_name)
+
+    def job_series_query(self, metric_name):
+        """Query template for metric data restricted to the job, retaining all labels of the metric"""
+        return "%s * on (instance) group_left() (max by (instance) (rmsjob_info{$job,$step}))" % (metric_name)
+
+    def split_series_by_card(self, results):
+        """
+        Organize raw time series from a job query by card.
+
+        Result:
+            dict: (times, values, hosts) lists for each card, following the
+            raw format of query_time_series_data.
+        """
+        series = {}
+        for result in results:
+            card = result["metric"].get("card")
+            tmpresult = np.asarray(result["values"])
+            times, values, hosts = series.setdefault(card, ([], [], []))
+            # millisecond resolution preserves sub-second sampling intervals when aligning series
+            times.append(np.round(tmpresult[:, 0].astype(float) * 1000).astype("datetime64[ms]"))
+            values.append(tmpresult[:, 1].astype(float))
+            hosts.append(result["metric"].get("instance"))
+        return series
+
+    def reduce_time_series(self, times_raw, values_raw):
+        """
+        Compute [mean] and [max] values at each timestamp across multiple raw
+        time series (equivalent to avg() and max() queries).
+
+        Result:
+            tuple: arrays with times, mean values and max values.
+        """
+        if len(values_raw) == 1:
+            return times_raw[0], values_raw[0], values_raw[0]
+
+        times = np.unique(np.concatenate(times_raw))
+        sums = np.zeros(len(times))
+        counts = np.zeros(len(times))
+        maxes = np.full(len(times), -np.inf)
+        for i in range(len(values_raw)):
+            index = np.searchsorted(times, times_raw[i])
+            np.add.at(sums, index, values_raw[i])
+            np.add.at(counts, index, 1)
+            np.maximum.at(maxes, index, values_raw[i])
+        return times, sums / counts, maxes
+
+    def query_time_series_data(self, metric_name, reducer=None, dataType=float):
+
+        results = self.query_job_range(self.job_query(metric_name, reducer), shard_hosts=reducer is None)
 
         if reducer is None:
             # return lists with raw time series data from all hosts for given metric
@@ -1101,9 +1562,8 @@ class QueryMetrics:
         index = ["timestamp"] + pivot_labels
 
         metric_dfs = []
-        for metric in metrics:
-            query = "%s * on (instance) group_left() (max by (instance) (rmsjob_info{$job,$step}))" % (metric)
-            metric_data = self.query_job_range(query)
+        results = self.query_job_ranges([self.job_series_query(metric) for metric in metrics], shard_hosts=True)
+        for metric, metric_data in zip(metrics, results):
 
             if len(metric_data) == 0:
                 continue
@@ -1129,7 +1589,75 @@ class QueryMetrics:
             df = pandas.concat(metric_dfs, axis=1)
             df.to_csv(output_file)
 
-    def export(self, export_path):
+    def export_metrics_parquet(self, output_file, metrics, pivot_labels):
+        """Export time series for given metrics as a Parquet file.
+
+        Samples are stored in long format with one row per sample: timestamp,
+        metric name, one column per label in "pivot_labels", and value. Label
+        and metric columns are dictionary-encoded. Metrics are queried one at
+        a time, and each host shard and time chunk of a metric is converted
+        and written as a separate row group as soon as it is received, so
+        only a single chunk is held in memory at a time. For example:
+         | timestamp           | metric                      | instance | card | value |
+         | ------------------- | --------------------------- | -------- | ---- | ----- |
+         | 2025-01-01 10:00:00 | rocm_utilization_percentage | node01   | 0    | 100.0 |
+         | 2025-01-01 10:00:00 | rocm_utilization_percentage | node01   | 1    | 100.0 |
+         | ...                 | ...                         | ...      | ...  | ...   |
+
+        Args:
+            output_file (string): path to output Parquet file
+            metrics (list): list of metrics to export
+            pivot_labels (list): list of labels to store as columns
+        """
+        try:
+            import pyarrow
+            import pyarrow.parquet
+        except ImportError:
+            utils.error("Parquet export requires the pyarrow package")
+
+        string_dict = pyarrow.dictionary(pyarrow.int32(), pyarrow.string())
+        fields = [("timestamp", pyarrow.timestamp("ms")), ("metric", string_dict)]
+        fields += [(label, string_dict) for label in pivot_labels]
+        fields += [("value", pyarrow.float64())]
+        schema = pyarrow.schema(fields)
+
+        writer = None
+        for metric in metrics:
+            for metric_data in self.query_job_range_chunks(self.job_series_query(metric), shard_hosts=True):
+                timestamps = []
+                values = []
+                labels = {label: [] for label in pivot_labels}
+                for series in metric_data:
+                    num_samples = len(series["values"])
+                    for timestamp, value in series["values"]:
+                        timestamps.append(round(float(timestamp) * 1000))
+                        values.append(float(value))
+                    for label in pivot_labels:
+                        labels[label] += [series["metric"].get(label, "")] * num_samples
+                del metric_data
+                if len(values) == 0:
+                    continue
+
+                columns = [
+                    pyarrow.array(timestamps, pyarrow.timestamp("ms")),
+                    pyarrow.array([metric] * len(values), pyarrow.string()).dictionary_encode(),
+                ]
+                columns += [
+                    pyarrow.array(labels[label], pyarrow.string()).dictionary_encode() for label in pivot_labels
+                ]
+                columns += [pyarrow.array(values, pyarrow.float64())]
+                table = pyarrow.Table.from_arrays(columns, schema=schema)
+                del timestamps, values, labels, columns
+
+                if writer is None:
+                    writer = pyarrow.parquet.ParquetWriter(output_file, schema)
+                writer.write_table(table, row_group_size=table.num_rows)
+                del table
+
+        if writer is not None:
+            writer.close()
+
+    def export(self, export_path, export_format="csv"):
         export_prefix = "omnistat-"
 
         # List files to be generated for different subsets of metrics. Values
@@ -1156,6 +1684,17 @@ class QueryMetrics:
                 ["omnistat_fom"],
                 ["instance", "name"],
             ),
+            (
+                "burst",
+                [
+                    "rocm_average_socket_power_watts_burst",
+                    "rocm_utilization_percentage_burst",
+                    "rocm_vram_busy_percentage_burst",
+                    "rocm_sclk_clock_mhz_burst",
+                    "rocm_mclk_clock_mhz_burst",
+                ],
+                ["instance", "card"],
+            ),
             (
                 "vendor",
                 [
@@ -1176,9 +1715,12 @@ class QueryMetrics:
         ]
 
         for name, metrics, labels in exports:
-            extension = ".gpu.csv" if "card" in labels else ".csv"
+            extension = f".gpu.{export_format}" if "card" in labels else f".{export_format}"
             export_file = f"{export_path}/{export_prefix}{name}{extension}"
-            self.export_metrics(export_file, metrics, labels)
+            if export_format == "parquet":
+                self.export_metrics_parquet(export_file, metrics, labels)
+            else:
+                self.export_metrics(export_file, metrics, labels)
 
 
 def main():
@@ -1193,6 +1735,12 @@ def main():
     parser.add_argument("--output", help="redirect plain text report to existing file")
     parser.add_argument("--pdf", help="generate PDF report")
     parser.add_argument("--export", help="export metric time-series in CSV format", nargs="?", default=None, const="./")
+    parser.add_argument(
+        "--export-format",
+        help="file format for exported time-series (default=csv)",
+        choices=["csv", "parquet"],
+        default="csv",
+    )
     args = parser.parse_args()
 
     # logger config
@@ -1218,7 +1766,7 @@ def main():
             utils.error(f"--export argument should be be an existing or new directory directory")
 
         export_path.mkdir(exist_ok=True)
-        query.export(export_path)
+        query.export(export_path, args.export_format)
 
 
 if __name__ == "__main__":
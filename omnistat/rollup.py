@@ -0,0 +1,212 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+
+"""On-node rollups of user-mode samples
+
+Instead of caching every raw sample for delivery, per-series statistics are
+accumulated over fixed windows aligned to multiples of the rollup interval
+and emitted once per window:
+
+  <name>                  mean over the window
+  <name>_min, <name>_max  extrema over the window
+  <name>_last             last value in the window
+  <base>_energy_joules    cumulative energy for power metrics (<base>_watts),
+                          integrated with the trapezoidal rule over raw samples
+
+Counters are reduced to their last value. Optionally, raw samples of selected
+metrics are retained (in place of the window mean) for windows in which a
+threshold is crossed.
+"""
+
+import operator
+import re
+from array import array
+
+STATS = ("_min", "_max", "_last")
+
+THRESHOLD_OPERATORS = {">": operator.gt, ">=": operator.ge, "<": operator.lt, "<=": operator.le}
+
+
+def parse_thresholds(setting):
+    """Parse comma-separated name>value (or >=, <, <=) entries
+
+    Returns:
+        dict: metric name -> (comparison, threshold value)
+    """
+    thresholds = {}
+    for entry in setting.split(","):
+        entry = entry.strip()
+        if not entry:
+            continue
+        match = re.fullmatch(r"([A-Za-z_:][A-Za-z0-9_:]*)\s*(>=|<=|>|<)\s*(\S+)", entry)
+        if match is None:
+            raise ValueError("invalid threshold: %s" % entry)
+        name, op, value = match.groups()
+        thresholds[name] = (THRESHOLD_OPERATORS[op], float(value))
+    return thresholds
+
+
+class Rollup:
+    def __init__(self, window_secs, thresholds=None):
+        """
+        Args:
+            window_secs (float): rollup window
+            thresholds (dict): optional metric name -> (comparison, value) for raw data retention
+        """
+        self.__windowNs = int(round(window_secs * 1e9))
+        self.__thresholds = thresholds or {}
+        self.__series = []
+        self.__count = array("q")
+        self.__sum = array("d")
+        self.__min = array("d")
+        self.__max = array("d")
+        self.__last = array("d")
+        self.__lastTime = array("q")
+        self.__energy = {}
+        self.__raw = {}
+        self.__crossed = set()
+
+    @property
+    def window_ns(self):
+        return self.__windowNs
+
+    def next_boundary(self, timestamp_ns):
+        """First window boundary after timestamp"""
+        return (timestamp_ns // self.__windowNs + 1) * self.__windowNs
+
+    def track(self, seriesId, name, labels, kind):
+        """Register a series (by buffer series id) with its metric name, labels, and metric type"""
+        while len(self.__series) <= seriesId:
+            self.__series.append(None)
+            self.__count.append(0)
+            self.__sum.append(0.0)
+            self.__min.append(0.0)
+            self.__max.append(0.0)
+            self.__last.append(0.0)
+            self.__lastTime.append(0)
+        gauge = kind == "gauge" and not name.endswith("_info")
+        self.__series[seriesId] = (name, labels, gauge)
+        if gauge and name.endswith("_watts"):
+            # [cumulative joules, previous timestamp (msecs), previous value]
+            self.__energy[seriesId] = [0.0, None, 0.0]
+        if gauge and name in self.__thresholds:
+            self.__raw[seriesId] = []
+
+    def untrack(self, seriesId):
+        """Stop tracking a series (e.g. expired from the sample buffer)"""
+        if seriesId < len(self.__series):
+            self.__series[seriesId] = None
+            self.__count[seriesId] = 0
+        self.__energy.pop(seriesId, None)
+        self.__raw.pop(seriesId, None)
+        self.__crossed.discard(seriesId)
+
+    def add(self, seriesId, timestamp_msecs, value):
+        count = self.__count[seriesId]
+        if count == 0:
+            self.__min[seriesId] = value
+            self.__max[seriesId] = value
+            self.__sum[seriesId] = value
+        else:
+            if value < self.__min[seriesId]:
+                self.__min[seriesId] = value
+            if value > self.__max[seriesId]:
+                self.__max[seriesId] = value
+            self.__sum[seriesId] += value
+        self.__count[seriesId] = count + 1
+        self.__last[seriesId] = value
+        self.__lastTime[seriesId] = timestamp_msecs
+
+        energy = self.__energy.get(seriesId)
+        if energy is not None:
+            if energy[1] is not None:
+                energy[0] += 0.5 * (energy[2] + value) * (timestamp_msecs - energy[1]) / 1000.0
+            energy[1] = timestamp_msecs
+            energy[2] = value
+
+        raw = self.__raw.get(seriesId)
+        if raw is not None:
+            raw.append((timestamp_msecs, value))
+            compare, threshold = self.__thresholds[self.__series[seriesId][0]]
+            if compare(value, threshold):
+                self.__crossed.add(seriesId)
+
+    def flush(self, emit):
+        """Emit statistics for the completed window via emit(seriesId, suffix, timestamp_msecs, value)
+
+        Suffix is "" for values reported under the original series, otherwise the name of the
+        derived series (e.g. "_max" or "_energy_joules").
+
+        Returns:
+            int: number of samples emitted
+        """
+        emitted = 0
+        for seriesId, series in enumerate(self.__series):
+            count = self.__count[seriesId]
+            if series is None or count == 0:
+                continue
+            name, labels, gauge = series
+            timestamp = self.__lastTime[seriesId]
+            if not gauge:
+                emit(seriesId, "", timestamp, self.__last[seriesId])
+                emitted += 1
+                self.__count[seriesId] = 0
+                continue
+
+            raw = self.__raw.get(seriesId)
+            if raw is not None and seriesId in self.__crossed:
+                for rawTime, rawValue in raw:
+                    emit(seriesId, "", rawTime, rawValue)
+                emitted += len(raw)
+            else:
+                emit(seriesId, "", timestamp, self.__sum[seriesId] / count)
+                emitted += 1
+            if raw is not None:
+                raw.clear()
+
+            emit(seriesId, "_min", timestamp, self.__min[seriesId])
+            emit(seriesId, "_max", timestamp, self.__max[seriesId])
+            emit(seriesId, "_last", timestamp, self.__last[seriesId])
+            emitted += 3
+
+            energy = self.__energy.get(seriesId)
+            if energy is not None:
+                emit(seriesId, "_energy_joules", timestamp, energy[0])
+                emitted += 1
+
+            self.__count[seriesId] = 0
+
+        self.__crossed.clear()
+        return emitted
+
+    def derived_name(self, seriesId, suffix):
+        """Metric name of a derived series"""
+        name = self.__series[seriesId][0]
+        if suffix == "_energy_joules":
+            return name.removesuffix("_watts") + suffix
+        return name + suffix
+
+    def labels(self, seriesId):
+        return self.__series[seriesId][1]
@@ -0,0 +1,178 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+"""Columnar in-memory sample storage for user-mode data collection
+
+Samples are stored as three parallel, preallocated columns (series id, timestamp
+in milliseconds, and float64 value) using array-module storage. The text prefix
+for each series (metric name and labels) is interned once when the series is
+first observed; text serialization happens only when cached samples are pushed.
+Series that are no longer observed (e.g. exited processes) can be dropped from
+the intern table with expire().
+
+Two blocks of storage are used in alternation: the active block receives new
+samples while a drained block is serialized and pushed in the background. Once
+released, a drained block is reused as the next active block so memory is not
+reallocated between pushes. Blocks grow geometrically when full, and storage is
+extended in bounded steps to avoid large temporary allocations.
+"""
+
+import threading
+from array import array
+
+# bytes of storage per sample (series id, timestamp, and value)
+BYTES_PER_SAMPLE = 4 + 8 + 8
+
+# columns are extended by at most this number of elements at a time
+GROW_STEP = 65536
+ZEROS = {typecode: array(typecode, bytes(array(typecode).itemsize * GROW_STEP)) for typecode in "Iqd"}
+
+
+def extend(column, count):
+    """Append count zero elements to an array column"""
+    zeros = ZEROS[column.typecode]
+    while count > 0:
+        step = min(count, GROW_STEP)
+        column.extend(zeros if step == GROW_STEP else zeros[:step])
+        count -= step
+
+
+class SampleBlock:
+    """Fixed-capacity set of sample columns (grows only when capacity is exhausted)"""
+
+    def __init__(self, capacity):
+        self.capacity = 0
+        self.count = 0
+        self.ids = array("I")
+        self.timestamps = array("q")
+        self.values = array("d")
+        self.reserve(max(1, capacity))
+
+    def reserve(self, capacity):
+        """Expand storage to hold at least capacity samples"""
+        if capacity <= self.capacity:
+            return
+        extra = capacity - self.capacity
+        extend(self.ids, extra)
+        extend(self.timestamps, extra)
+        extend(self.values, extra)
+        self.capacity = capacity
+
+
+class SampleBuffer:
+    def __init__(self, capacity=65536):
+        self.__seriesIds = {}
+        self.__prefixes = {}
+        self.__nextId = 0
+        self.__seen = bytearray()
+        self.__active = SampleBlock(capacity)
+        self.__spare = None
+        self.__lock = threading.Lock()
+
+    def __len__(self):
+        return self.__active.count
+
+    def lookup(self, key):
+        """Return id of an interned series (or None if series has not been observed)"""
+        return self.__seriesIds.get(key)
+
+    def addSeries(self, key, prefix):
+        """Intern a new series with text prefix used during serialization, i.e. name{labels}"""
+        seriesId = self.__nextId
+        self.__nextId += 1
+        self.__prefixes[seriesId] = prefix
+        self.__seriesIds[key] = seriesId
+        self.__seen.append(1)
+        return seriesId
+
+    def numSeries(self):
+        return len(self.__prefixes)
+
+    def append(self, seriesId, timestamp_msecs, value):
+        block = self.__active
+        index = block.count
+        if index == block.capacity:
+            block.reserve(2 * block.capacity)
+        block.ids[index] = seriesId
+        block.timestamps[index] = timestamp_msecs
+        block.values[index] = value
+        block.count = index + 1
+        self.__seen[seriesId] = 1
+
+    def touch(self, seriesId):
+        """Mark a series as observed without caching a sample (e.g. accumulated in a rollup)"""
+        self.__seen[seriesId] = 1
+
+    def expire(self):
+        """Drop series not appended (or touched) since the previous call; call right after drain()
+
+        Ids of expired series are not reused, so they may only remain cached by callers until
+        the series is observed again (and interned with a new id).
+
+        Returns:
+            list: ids of expired series
+        """
+        seen = self.__seen
+        expired = [seriesId for seriesId in self.__prefixes if not seen[seriesId]]
+        if expired:
+            expiredIds = set(expired)
+            for key in [key for key, seriesId in self.__seriesIds.items() if seriesId in expiredIds]:
+                del self.__seriesIds[key]
+            for seriesId in expired:
+                del self.__prefixes[seriesId]
+        for seriesId in self.__prefixes:
+            seen[seriesId] = 0
+        return expired
+
+    def reserve(self, capacity):
+        """Preallocate storage for at least capacity samples"""
+        self.__active.reserve(capacity)
+
+    def drain(self):
+        """Detach current samples for serialization; new samples are cached in a reused (or new) block"""
+        with self.__lock:
+            block = self.__active
+            spare = self.__spare
+            self.__spare = None
+        if spare is None:
+            spare = SampleBlock(block.capacity)
+        else:
+            spare.reserve(block.capacity)
+        self.__active = spare
+        return block
+
+    def release(self, block):
+        """Return a drained block for reuse once its samples have been delivered"""
+        block.count = 0
+        with self.__lock:
+            self.__spare = block
+
+    def lines(self, block):
+        """Generator providing text exposition for each sample in a drained block"""
+        prefixes = self.__prefixes
+        ids = block.ids
+        timestamps = block.timestamps
+        values = block.values
+        for index in range(block.count):
+            yield "%s %s %i" % (prefixes[ids[index]], values[index], timestamps[index])
@@ -0,0 +1,121 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+"""Absolute-deadline scheduler for periodic sampling
+
+Deadlines are placed on integer multiples of the sampling interval in wall-clock
+time (CLOCK_REALTIME) so that samples taken on different nodes with synchronized
+clocks share the same timestamps. Sleeps use clock_nanosleep() with TIMER_ABSTIME
+which avoids accumulating drift from the time spent collecting each sample. When
+a sample overruns its interval, intervening deadlines are skipped (and counted)
+to preserve alignment.
+"""
+
+import ctypes
+import ctypes.util
+import errno
+import logging
+import time
+
+CLOCK_REALTIME = 0
+TIMER_ABSTIME = 1
+
+
+class timespec(ctypes.Structure):
+    _fields_ = [("tv_sec", ctypes.c_long), ("tv_nsec", ctypes.c_long)]
+
+
+class DeadlineScheduler:
+    def __init__(self, interval_secs):
+        self.__interval_ns = int(round(interval_secs * 1e9))
+        self.__deadline_ns = None
+        self.__missed = 0
+        self.__overruns = 0
+        self.__request = timespec()
+
+        self.__clock_nanosleep = None
+        try:
+            libc = ctypes.CDLL(ctypes.util.find_library("c") or "libc.so.6", use_errno=True)
+            self.__clock_nanosleep = libc.clock_nanosleep
+            self.__clock_nanosleep.argtypes = [
+                ctypes.c_int,
+                ctypes.c_int,
+                ctypes.POINTER(timespec),
+                ctypes.POINTER(timespec),
+            ]
+            self.__clock_nanosleep.restype = ctypes.c_int
+        except (OSError, AttributeError):
+            logging.info("clock_nanosleep() unavailable, using time.sleep() for sampling deadlines")
+
+    @property
+    def deadline_ns(self):
+        """Current deadline (nanoseconds since epoch)"""
+        return self.__deadline_ns
+
+    @property
+    def missed(self):
+        """Total number of deadlines skipped due to overruns"""
+        return self.__missed
+
+    @property
+    def overruns(self):
+        """Total number of samples that exceeded their interval"""
+        return self.__overruns
+
+    def start(self):
+        """Wait until the first aligned deadline and return it (nanoseconds since epoch)"""
+        now = time.time_ns()
+        self.__deadline_ns = (now // self.__interval_ns + 1) * self.__interval_ns
+        self.sleep_until(self.__deadline_ns)
+        return self.__deadline_ns
+
+    def wait(self):
+        """Wait until the next aligned deadline; returns number of deadlines skipped since last call"""
+        self.__deadline_ns += self.__interval_ns
+        now = time.time_ns()
+        skipped = 0
+        if now > self.__deadline_ns:
+            skipped = (now - self.__deadline_ns) // self.__interval_ns + 1
+            self.__deadline_ns += skipped * self.__interval_ns
+            self.__missed += skipped
+            self.__overruns += 1
+        self.sleep_until(self.__deadline_ns)
+        return skipped
+
+    def sleep_until(self, deadline_ns):
+        """Sleep until absolute wall-clock time (nanoseconds since epoch)"""
+        if self.__clock_nanosleep is None:
+            delay = (deadline_ns - time.time_ns()) / 1e9
+            if delay > 0:
+                time.sleep(delay)
+            return
+
+        self.__request.tv_sec = deadline_ns // 1000000000
+        self.__request.tv_nsec = deadline_ns % 1000000000
+        while True:
+            ret = self.__clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, ctypes.byref(self.__request), None)
+            # resume sleep if interrupted by a signal
+            if ret != errno.EINTR:
+                break
+        return
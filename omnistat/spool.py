@@ -0,0 +1,219 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+"""On-node spool for user-mode telemetry pushes
+
+Encoded push payloads are written as append-only segment files in a node-local
+directory (e.g. tmpfs or NVMe) and delivered asynchronously, oldest first, by a
+background drainer thread. A segment is removed only after it has been accepted
+by the server; while the server is slow or unreachable, segments accumulate on
+disk (rather than in collector memory) and delivery is retried with backoff.
+
+The spool is bounded: when the configured capacity is exceeded, the oldest
+segments are discarded. Each spool is private to a user, job, and target
+server (see spool_directory), so segments left behind by a previous run are
+only replayed at startup by a run of the same job pushing to the same server.
+"""
+
+import collections
+import hashlib
+import logging
+import os
+import threading
+import time
+
+
+def spool_directory(base, user, jobid, endpoint):
+    """
+    Spool location for a given user, job, and target server.
+
+    Args:
+        base (str): configured spool directory (may be shared across users and jobs)
+        user (str): user name
+        jobid (str): resource manager job ID
+        endpoint (str): target server URL
+    Returns:
+        str: path of the form <base>/<user>/<jobid>-<endpoint-hash>
+    """
+    endpointHash = hashlib.sha1(endpoint.encode()).hexdigest()[:12]
+    return os.path.join(base, user, "%s-%s" % (jobid, endpointHash))
+
+
+class Spool:
+    def __init__(self, directory, max_bytes, prefix, send, notify=None):
+        """
+        Args:
+            directory (str): spool location (see spool_directory), created if needed
+            max_bytes (int): maximum combined size of spooled segments
+            prefix (str): segment filename prefix (e.g. hostname)
+            send (callable): send(payload, compressed) -> bool delivers a single segment
+            notify (callable): optional callback invoked once all pending segments are delivered
+        """
+        self.__directory = directory
+        self.__maxBytes = max_bytes
+        self.__prefix = prefix
+        self.__send = send
+        self.__notify = notify
+        self.__segments = collections.deque()
+        self.__bytes = 0
+        self.__sequence = 0
+        self.__dropped = 0
+        self.__delivered = 0
+        self.__lock = threading.Lock()
+        self.__wakeup = threading.Event()
+        self.__stopping = False
+        self.__thread = None
+
+        # private to the user: raises OSError if the location is not writable
+        os.makedirs(directory, mode=0o700, exist_ok=True)
+        if os.stat(directory).st_uid != os.getuid() or not os.access(directory, os.W_OK | os.X_OK):
+            raise PermissionError("spool directory is not owned by or writable for the current user: %s" % directory)
+
+        # pick up segments remaining from a previous run of the same job
+        for entry in sorted(os.listdir(directory)):
+            if entry.startswith(prefix + "-") and not entry.endswith(".tmp"):
+                path = os.path.join(directory, entry)
+                size = os.path.getsize(path)
+                self.__segments.append((path, size))
+                self.__bytes += size
+        if self.__segments:
+            logging.info(
+                "Replaying %i spooled segment(s) (%.1f MB) from %s"
+                % (len(self.__segments), self.__bytes / 1024 / 1024, directory)
+            )
+        self.evict()
+
+    @property
+    def pending(self):
+        """Number of segments awaiting delivery"""
+        return len(self.__segments)
+
+    @property
+    def dropped(self):
+        """Number of segments discarded due to spool capacity"""
+        return self.__dropped
+
+    @property
+    def delivered(self):
+        """Number of segments delivered"""
+        return self.__delivered
+
+    def write(self, payload, compressed):
+        """Append a payload to the spool as a new segment"""
+        self.__sequence += 1
+        suffix = "prom.gz" if compressed else "prom"
+        name = "%s-%020i-%06i.%s" % (self.__prefix, time.time_ns(), self.__sequence, suffix)
+        path = os.path.join(self.__directory, name)
+        with open(path + ".tmp", "wb") as f:
+            f.write(payload)
+        os.replace(path + ".tmp", path)
+        with self.__lock:
+            self.__segments.append((path, len(payload)))
+            self.__bytes += len(payload)
+        self.evict()
+        self.__wakeup.set()
+
+    def evict(self):
+        """Discard oldest segments while over capacity"""
+        with self.__lock:
+            while self.__bytes > self.__maxBytes and len(self.__segments) > 1:
+                path, size = self.__segments.popleft()
+                self.__bytes -= size
+                self.__dropped += 1
+                try:
+                    os.remove(path)
+                except FileNotFoundError:
+                    pass
+                logging.warning("[WARN]: Spool capacity exceeded, discarded oldest segment (%s)" % path)
+
+    def start(self):
+        self.__thread = threading.Thread(target=self.drain, name="omnistat-spool", daemon=True)
+        self.__thread.start()
+
+    def stop(self, timeout=None):
+        """Deliver remaining segments (until the first failure) and stop the drainer thread"""
+        self.__stopping = True
+        self.__wakeup.set()
+        if self.__thread is not None:
+            self.__thread.join(timeout)
+        if self.__segments:
+            logging.warning(
+                "[WARN]: %i segment(s) remain spooled in %s for delivery on next run"
+                % (len(self.__segments), self.__directory)
+            )
+
+    def drain(self):
+        """Drainer thread: deliver segments oldest first, backing off while delivery fails"""
+        backoff_min = 1.0
+        backoff_max = 60.0
+        backoff = backoff_min
+        notify_pending = False
+
+        while True:
+            with self.__lock:
+                segment = self.__segments[0] if self.__segments else None
+
+            if segment is None:
+                if notify_pending and self.__notify:
+                    self.__notify()
+                notify_pending = False
+                if self.__stopping:
+                    return
+                self.__wakeup.wait()
+                self.__wakeup.clear()
+                continue
+
+            path, size = segment
+            try:
+                with open(path, "rb") as f:
+                    payload = f.read()
+            except FileNotFoundError:
+                # segment evicted meanwhile
+                self.release(segment)
+                continue
+
+            if self.__send(payload, path.endswith(".gz")):
+                self.release(segment)
+                try:
+                    os.remove(path)
+                except FileNotFoundError:
+                    pass
+                self.__delivered += 1
+                notify_pending = True
+                backoff = backoff_min
+                continue
+
+            if self.__stopping:
+                return
+            logging.info("Spool delivery failed, retrying in %.1f sec (%i pending)" % (backoff, self.pending))
+            self.__wakeup.wait(backoff)
+            self.__wakeup.clear()
+            backoff = min(2 * backoff, backoff_max)
+
+    def release(self, segment):
+        """Remove a segment from the pending queue"""
+        with self.__lock:
+            if self.__segments and self.__segments[0] == segment:
+                self.__segments.popleft()
+                self.__bytes -= segment[1]
@@ -28,7 +28,9 @@
 # --> provides a flask endpoint to terminate data collection (http://host:port/shutdown)
 
 import argparse
-import ctypes
+import gzip
+import importlib
+import itertools
 import logging
 import os
 import platform
@@ -40,14 +42,20 @@ import time
 import warnings
 from datetime import datetime, timezone
 
-import requests
-from flask import Flask, abort, jsonify, request
-from prometheus_client import REGISTRY, Gauge
+from prometheus_client import REGISTRY, Counter, Gauge
 
 from omnistat import utils
+from omnistat.annotate import omnistat_annotate
+from omnistat.burst import BurstSampler
+from omnistat.fom import FOMSocket, default_socket_path
 from omnistat.monitor import Monitor
+from omnistat.rollup import Rollup, parse_thresholds
+from omnistat.sample_buffer import BYTES_PER_SAMPLE, SampleBuffer
+from omnistat.scheduler import DeadlineScheduler
+from omnistat.spool import Spool, spool_directory
 
-app = Flask(__name__)
+# Flask and requests are imported on first use (see createApp) to keep them off the exporter
+# startup path; Flask is preloaded in the background while collectors are initialized.
 terminateFlagEvent = threading.Event()
 dataDeliveredEvent = threading.Event()
 
@@ -55,35 +63,121 @@ fomData = []
 fomLock = threading.Lock()
 
 
-def push_to_victoria_metrics(metrics_data_list, victoria_url):
+def deliverFOM(samples):
+    """Queue FOM samples for caching by the polling loop"""
+    with fomLock:
+        fomData.extend(samples)
+
+
+# high-rate burst sampler (when enabled)
+burstSampler = None
+
+
+def encode_metric_chunks(metrics_data, chunk_samples, compression="gzip"):
+    """Generator providing bounded payloads of text exposition data
+
+    Args:
+        metrics_data (iterable): samples in Prometheus text exposition (one per entry)
+        chunk_samples (int): maximum number of samples per payload
+        compression (str): payload compression ("gzip" or "none")
+
+    Yields:
+        tuple: (payload bytes, # of samples in payload)
+    """
+    lines = iter(metrics_data)
+    while True:
+        chunk = list(itertools.islice(lines, chunk_samples))
+        if not chunk:
+            return
+        payload = ("\n".join(chunk) + "\n").encode()
+        if compression == "gzip":
+            payload = gzip.compress(payload, compresslevel=1)
+        yield payload, len(chunk)
+
+
+def post_metric_chunk(victoria_url, payload, headers, retries):
+    """Post a single payload to VictoriaMetrics, retrying with backoff on failure"""
+    import requests
+
+    for attempt in range(retries + 1):
+        if attempt > 0:
+            delay = 0.5 * 2 ** (attempt - 1)
+            logging.info("Retrying metric push (attempt %i, sleeping for %.1f sec)" % (attempt, delay))
+            time.sleep(delay)
+        try:
+            response = requests.post(victoria_url + "/api/v1/import/prometheus", data=payload, headers=headers)
+        except requests.ConnectionError:
+            logging.error("")
+            logging.error(
+                "[FAILED]: Unable to make connection - please verify VictoriaMetrics is running and accessible from this host."
+            )
+            continue
+        except Exception as e:
+            logging.error("")
+            logging.error("[FAILED]: Unable to post data to Victoria endpoint")
+            logging.error(e)
+            continue
+
+        if response.status_code != 204:
+            logging.error("")
+            logging.error(f"[FAILED] Unable to push metrics: {response.status_code}, {response.text}")
+            continue
+        return True
+    return False
+
+
+def push_to_victoria_metrics(metrics_data_list, victoria_url, compression="gzip", chunk_samples=100000, retries=2):
+    """Push cached samples to VictoriaMetrics in bounded (optionally compressed) chunks
+
+    Each chunk is posted and retried independently so that a failure only impacts the samples
+    contained within that chunk.
+
+    Args:
+        metrics_data_list (iterable): samples in Prometheus text exposition (one per entry)
+        victoria_url (str): VictoriaMetrics endpoint
+        compression (str): payload compression ("gzip" or "none")
+        chunk_samples (int): maximum number of samples per chunk
+        retries (int): number of retries per chunk
+
+    Returns:
+        bool: True if all chunks were delivered
+    """
     logging.info("Pushing local node telemetry to VictoriaMetrics endpoint -> %s" % victoria_url)
     headers = {
         "Content-Type": "text/plain",
     }
-
-    metrics_data = "\n".join(metrics_data_list)
-    try:
-        response = requests.post(victoria_url + "/api/v1/import/prometheus", data=metrics_data, headers=headers)
-    except requests.ConnectionError:
+    if compression == "gzip":
+        headers["Content-Encoding"] = "gzip"
+
+    num_chunks = 0
+    failed_chunks = 0
+    failed_samples = 0
+    for payload, num_samples in encode_metric_chunks(metrics_data_list, chunk_samples, compression):
+        num_chunks += 1
+        logging.debug("--> Pushing chunk %i (%i samples, %i bytes)" % (num_chunks, num_samples, len(payload)))
+        if not post_metric_chunk(victoria_url, payload, headers, retries):
+            failed_chunks += 1
+            failed_samples += num_samples
+
+    if failed_chunks > 0:
         logging.error("")
         logging.error(
-            "[FAILED]: Unable to make connection - please verify VictoriaMetrics is running and accessible from this host."
+            "[FAILED]: Unable to push %i of %i chunk(s) (%i samples dropped)"
+            % (failed_chunks, num_chunks, failed_samples)
         )
-        return
-    except Exception as e:
-        logging.error("")
-        logging.error("[FAILED]: Unable to post data to Victoria endpoint")
-        logging.error(e)
-        return
-
-    if response.status_code != 204:
-        logging.error("")
-        logging.error(f"[FAILED] Unable to push metrics: {response.status_code}, {response.text}")
-        return
+        if failed_chunks == num_chunks:
+            return False
     else:
         logging.info("Metrics pushed successfully!")
 
-    # notify on backfill event
+    notify_victoria_metrics(victoria_url)
+    return failed_chunks == 0
+
+
+def notify_victoria_metrics(victoria_url):
+    """Notify VictoriaMetrics on backfill event"""
+    import requests
+
     endpoints = ["/internal/resetRollupResultCache", "/internal/force_flush"]
     for endpoint in endpoints:
         try:
@@ -104,7 +198,7 @@ def push_to_victoria_metrics(metrics_data_list, victoria_url):
 class Standalone:
     def __init__(self, args, config):
         logging.basicConfig(format="%(message)s", level=logging.ERROR, stream=sys.stdout, flush=True)
-        self.__dataVM = []
+        self.__buffer = SampleBuffer()
         self.__hostname = platform.node().split(".", 1)[0]
         self.__instanceLabel = 'instance="%s"' % self.__hostname
 
@@ -125,6 +219,85 @@ class Standalone:
 
         self.__victoriaURL = f"http://{args.endpoint}:{args.port}"
 
+        # push settings
+        self.__pushCompression = config["omnistat.usermode"].get("push_compression", "gzip")
+        if self.__pushCompression not in ["gzip", "none"]:
+            logging.error("")
+            logging.error(
+                '[ERROR]: Unsupported push_compression setting (%s): use "gzip" or "none"' % self.__pushCompression
+            )
+            sys.exit(1)
+        self.__pushChunkSamples = config["omnistat.usermode"].getint("push_chunk_samples", 100000)
+        if self.__pushChunkSamples < 1:
+            logging.error("")
+            logging.error("[ERROR]: Please set push_chunk_samples >= 1 (%s)" % self.__pushChunkSamples)
+            sys.exit(1)
+        self.__pushRetries = config["omnistat.usermode"].getint("push_retries", 2)
+        self.__maxReserveBytes = config["omnistat.usermode"].getint("max_reserve_mb", 64) * 1024 * 1024
+
+        # counters and histograms are only cached for omnistat self-metrics (e.g. skip python_gc_* and process_*)
+        self.__selfMetricPrefixes = ("omnistat_sampling_",)
+        if config["omnistat.collectors"].getboolean("enable_collector_stats", False):
+            self.__selfMetricPrefixes += ("omnistat_collector_",)
+
+        # optional on-node spool: pushes are staged on local storage and delivered asynchronously
+        self.__spool = None
+        spoolDir = config["omnistat.usermode"].get("spool_dir", "")
+        if spoolDir:
+            spoolMaxBytes = config["omnistat.usermode"].getint("spool_max_mb", 1024) * 1024 * 1024
+            spoolDir = spool_directory(spoolDir, pwd.getpwuid(uid).pw_name, args.jobid, self.__victoriaURL)
+            try:
+                self.__spool = Spool(
+                    spoolDir,
+                    spoolMaxBytes,
+                    self.__hostname,
+                    send=self.sendSegment,
+                    notify=lambda: notify_victoria_metrics(self.__victoriaURL),
+                )
+            except OSError as e:
+                logging.error("")
+                logging.error("[ERROR]: Unable to use spool directory %s (%s)" % (spoolDir, e))
+                logging.error("[ERROR]: Please set spool_dir to a writable location or leave it unset")
+                sys.exit(1)
+            logging.info("Spooling telemetry pushes via %s (max = %i MB)" % (spoolDir, spoolMaxBytes / 1024 / 1024))
+
+        # optional burst mode: high-rate ring buffer flushed around annotated (or requested) regions
+        self.__burstEnabled = config["omnistat.usermode"].getboolean("enable_burst", False)
+        self.__burstIntervalSecs = config["omnistat.usermode"].getfloat("burst_interval_secs", 0.01)
+        self.__burstWindowSecs = config["omnistat.usermode"].getfloat("burst_window_secs", 1.0)
+        self.__burstAnnotations = config["omnistat.usermode"].getboolean("burst_on_annotations", True)
+        self.__burst = None
+        self.__burstSeriesIds = None
+        if self.__burstEnabled and not (0.001 <= self.__burstIntervalSecs < args.interval):
+            logging.error("")
+            logging.error(
+                "[ERROR]: Please set burst_interval_secs >= 0.001 and below the sampling interval (%s)"
+                % self.__burstIntervalSecs
+            )
+            sys.exit(1)
+
+        # optional on-node rollups: per-window statistics are cached instead of raw samples
+        self.__rollup = None
+        self.__rollupSeriesIds = {}
+        rollupSecs = config["omnistat.usermode"].getfloat("rollup_secs", 0.0)
+        if rollupSecs > 0:
+            if rollupSecs < args.interval or rollupSecs > self.__pushFrequencyMins * 60:
+                logging.error("")
+                logging.error(
+                    "[ERROR]: Please set rollup_secs between the sampling and push intervals (%s)" % rollupSecs
+                )
+                sys.exit(1)
+            try:
+                thresholds = parse_thresholds(config["omnistat.usermode"].get("rollup_raw_thresholds", ""))
+            except ValueError as e:
+                logging.error("")
+                logging.error("[ERROR]: Unable to parse rollup_raw_thresholds setting (%s)" % e)
+                sys.exit(1)
+            self.__rollup = Rollup(rollupSecs, thresholds)
+            logging.info("Telemetry data will be rolled up every %.1f seconds" % rollupSecs)
+            for name, (compare, value) in thresholds.items():
+                logging.info("--> retaining raw %s samples when crossing %s" % (name, value))
+
         self.__fomCheckFrequencySecs = config["omnistat.usermode"].getint("fom_check_frequency_secs", 10)
         if self.__fomCheckFrequencySecs < 5:
             logging.error("")
@@ -133,6 +306,19 @@ class Standalone:
             )
             sys.exit(1)
 
+        # optional local socket for FOM samples (see omnistat.fom)
+        self.__fomSocket = None
+        if config["omnistat.usermode"].getboolean("enable_fom_socket", False):
+            fomSocketPath = config["omnistat.usermode"].get("fom_socket", default_socket_path())
+            try:
+                self.__fomSocket = FOMSocket(fomSocketPath, deliverFOM)
+            except OSError as e:
+                logging.error("")
+                logging.error("[ERROR]: Unable to create FOM socket %s (%s)" % (fomSocketPath, e))
+                sys.exit(1)
+            self.__fomSocket.start()
+            logging.info("Figure-of-merit (FOM) data will be accepted on %s" % fomSocketPath)
+
         logflask = logging.getLogger("werkzeug")
         logflask.setLevel(logging.ERROR)
 
@@ -140,10 +326,29 @@ class Standalone:
         self.__labelDefaults = self.__instanceLabel + "," + self.__userLabel
         logging.debug("Default metric labels = %s" % self.__labelDefaults)
 
-        # verify victoriaURL is operational and ready to receive queries (poll for a bit if necessary)
+        # verify victoriaURL is operational and ready to receive queries (polled in the background
+        # since it only results in a warning)
+        testURL = f"http://{args.endpoint}:{args.port}/ready"
+        threading.Thread(target=self.verifyVictoria, args=(testURL,), daemon=True).start()
+
+        logging.info("Telemetry data will be sampled every %.3f seconds" % args.interval)
+        logging.info("Cached data will be pushed every %.1f minute(s)" % self.__pushFrequencyMins)
+        logging.info("Figure-of-merit (FOM) data will be checked for every %i seconds" % self.__fomCheckFrequencySecs)
+
+        # self-metrics tracking adherence to sampling cadence
+        self.__overrunsCounter = Counter(
+            "omnistat_sampling_overruns", "Number of samples exceeding the sampling interval"
+        )
+        self.__missedDeadlinesCounter = Counter(
+            "omnistat_sampling_missed_deadlines", "Number of sampling deadlines skipped"
+        )
+
+    def verifyVictoria(self, testURL):
+        """Poll VictoriaMetrics ready endpoint for a bit, warning if it is not accessible"""
+        import requests
+
         failed = True
         delay_start = 0.05
-        testURL = f"http://{args.endpoint}:{args.port}/ready"
         for iter in range(1, 25):
             try:
                 response = requests.get(testURL)
@@ -165,16 +370,6 @@ class Standalone:
             logging.warning("[WARN]: Unable to access VictoriaMetrics server endpoint (%s)" % self.__victoriaURL)
             logging.warning("[WARN]: Please verify server is running and accessible from this host.")
 
-        logging.info("Telemetry data will be sampled every %.3f seconds" % args.interval)
-        logging.info("Cached data will be pushed every %.1f minute(s)" % self.__pushFrequencyMins)
-        logging.info("Figure-of-merit (FOM) data will be checked for every %i seconds" % self.__fomCheckFrequencySecs)
-
-        # Init glibc for usleep access
-        self.__libc = ctypes.CDLL("libc.so.6")
-
-    def sleep_microsecs(self, microsecs):
-        self.__libc.usleep(microsecs)
-
     def tokenizeMetricName(self, name, labels):
         token = name
         if "card" in labels:
@@ -183,51 +378,229 @@ class Standalone:
 
     def getMetrics(self, timestamp_millisecs, prefix=None):
         """Cache current metrics from latest query"""
+        buffer = self.__buffer
+        rollup = self.__rollup
         for metric in REGISTRY.collect():
-            if metric.type == "gauge":
+            if metric.type == "gauge" or metric.name.startswith(self.__selfMetricPrefixes):
                 if prefix and not metric.name.startswith(prefix):
                     continue
                 for sample in metric.samples:
-                    if sample.name == "rmsjob_info":
-                        labels = self.__instanceLabel
+                    # skip creation timestamps of counters/histograms
+                    if sample.name.endswith("_created"):
+                        continue
+                    key = (sample.name, tuple(sample.labels.items()))
+                    seriesId = buffer.lookup(key)
+                    if seriesId is None:
+                        seriesId = self.addSeries(key, sample.name, sample.labels)
+                        if rollup is not None:
+                            rollup.track(seriesId, sample.name, sample.labels, metric.type)
+                    if rollup is not None:
+                        rollup.add(seriesId, timestamp_millisecs, sample.value)
+                        buffer.touch(seriesId)
                     else:
-                        labels = self.__labelDefaults
-                    if sample.labels:
-                        for key, value in sample.labels.items():
-                            labels += ',%s="%s"' % (key, value)
-                    entry = "%s{%s} %s %i" % (sample.name, labels, sample.value, timestamp_millisecs)
-                    self.__dataVM.append(entry)
+                        buffer.append(seriesId, timestamp_millisecs, sample.value)
+
+    def addSeries(self, key, name, sampleLabels):
+        """Intern a new series with default labels for this host"""
+        if name == "rmsjob_info":
+            labels = self.__instanceLabel
+        else:
+            labels = self.__labelDefaults
+        if sampleLabels:
+            for label, value in sampleLabels.items():
+                labels += ',%s="%s"' % (label, value)
+        return self.__buffer.addSeries(key, "%s{%s}" % (name, labels))
+
+    def appendRollupSample(self, seriesId, suffix, timestamp_msecs, value):
+        """Cache a rollup statistic under its source series (suffix "") or a derived series"""
+        if suffix:
+            derivedId = self.__rollupSeriesIds.get((seriesId, suffix))
+            if derivedId is None:
+                name = self.__rollup.derived_name(seriesId, suffix)
+                labels = self.__rollup.labels(seriesId)
+                derivedId = self.addSeries((name, tuple(labels.items())), name, labels)
+                self.__rollupSeriesIds[(seriesId, suffix)] = derivedId
+            seriesId = derivedId
+        self.__buffer.append(seriesId, timestamp_msecs, value)
+
+    def expireSeries(self):
+        """Drop series not observed during the last push interval, along with their cached ids"""
+        expired = self.__buffer.expire()
+        if not expired:
+            return
+        expired = set(expired)
+        if self.__rollup:
+            for seriesId in expired:
+                self.__rollup.untrack(seriesId)
+            self.__rollupSeriesIds = {
+                key: derivedId
+                for key, derivedId in self.__rollupSeriesIds.items()
+                if key[0] not in expired and derivedId not in expired
+            }
+        if self.__burstSeriesIds:
+            self.__burstSeriesIds = [None if seriesId in expired else seriesId for seriesId in self.__burstSeriesIds]
+        logging.debug("Expired %i series not observed during the last push interval" % len(expired))
+
+    def startBurst(self, monitor, interval_secs):
+        """Start high-rate burst sampler for sources provided by enabled collectors"""
+        global burstSampler
+
+        sources = monitor.burstSources()
+        if not sources:
+            logging.warning("[WARN]: Burst mode requested, but no enabled collector provides burst metrics")
+            return
+        annotationFile = omnistat_annotate().filename if self.__burstAnnotations else None
+        # ring buffer covers the leading window of a region (with margin for annotation latency); rows
+        # within regions are captured by the sampler thread, independent of the time between drains
+        capacitySecs = self.__burstWindowSecs + interval_secs
+        self.__burst = BurstSampler(
+            sources, self.__burstIntervalSecs, self.__burstWindowSecs, capacitySecs, annotationFile=annotationFile
+        )
+        self.__burstSeriesIds = [None] * len(self.__burst.series)
+        self.__burst.start()
+        burstSampler = self.__burst
+        logging.info(
+            "Burst sampling enabled for %i series every %.3f seconds (window = %.2f seconds)"
+            % (len(self.__burst.series), self.__burstIntervalSecs, self.__burstWindowSecs)
+        )
+
+    def getBurstData(self):
+        """Cache burst samples captured within requested regions; returns # of samples cached"""
+        return self.__burst.drain(self.appendBurstSample)
+
+    def appendBurstSample(self, column, timestamp_msecs, value):
+        """Cache a burst sample under a separate <name>_burst series
+
+        Burst samples are not mixed with (or rolled up into) regular samples, which would otherwise
+        dominate averages over time of the source series within burst regions.
+        """
+        seriesId = self.__burstSeriesIds[column]
+        if seriesId is None:
+            name, labels = self.__burst.series[column]
+            name += "_burst"
+            key = (name, tuple(labels.items()))
+            seriesId = self.__buffer.lookup(key)
+            if seriesId is None:
+                seriesId = self.addSeries(key, name, labels)
+            self.__burstSeriesIds[column] = seriesId
+        self.__buffer.append(seriesId, timestamp_msecs, value)
+
+    def getFOMData(self):
+        """Cache figure-of-merit (FOM) data provided by the application; returns # of samples cached"""
+        buffer = self.__buffer
+        # swap out pending samples so that producers are not blocked while caching
+        with fomLock:
+            entries = fomData[:]
+            fomData.clear()
+        numSamples = len(entries)
+        for entry in entries:
+            try:
+                value = float(entry["value"])
+            except (TypeError, ValueError):
+                logging.warning("[WARN]: Ignoring non-numeric FOM value for %s (%s)" % (entry["name"], entry["value"]))
+                numSamples -= 1
+                continue
+            key = ("omnistat_fom", entry["name"])
+            seriesId = buffer.lookup(key)
+            if seriesId is None:
+                seriesId = buffer.addSeries(
+                    key, '%s{instance="%s",name="%s"}' % ("omnistat_fom", self.__hostname, entry["name"])
+                )
+            buffer.append(seriesId, entry["timestamp_msecs"], value)
+        logging.info("Registered %i sample(s) of FOM data" % numSamples)
+        return numSamples
+
+    def pushSamples(self, block):
+        """Serialize and push (or spool) a drained block of cached samples, then release it for reuse"""
+        if self.__spool:
+            for payload, num_samples in encode_metric_chunks(
+                self.__buffer.lines(block), self.__pushChunkSamples, self.__pushCompression
+            ):
+                self.__spool.write(payload, self.__pushCompression == "gzip")
+            self.__buffer.release(block)
+            return
+
+        push_to_victoria_metrics(
+            self.__buffer.lines(block),
+            self.__victoriaURL,
+            compression=self.__pushCompression,
+            chunk_samples=self.__pushChunkSamples,
+            retries=self.__pushRetries,
+        )
+        self.__buffer.release(block)
+
+    def sendSegment(self, payload, compressed):
+        """Deliver a single spooled segment to VictoriaMetrics"""
+        headers = {"Content-Type": "text/plain"}
+        if compressed:
+            headers["Content-Encoding"] = "gzip"
+        return post_metric_chunk(self.__victoriaURL, payload, headers, retries=0)
 
     def polling(self, monitor, interval_secs):
         """main polling function"""
 
         num_samples = 0
         num_fom_samples = 0
+        num_burst_samples = 0
+        num_rollup_samples = 0
         sample_duration = 0
         num_pushes = 0
-        push_check_duration = 0.0
         push_frequency_secs = self.__pushFrequencyMins * 60
         push_time_accumulation = 0.0
-        interval_microsecs = int(interval_secs * 1000000)
         mem_mb_base = utils.getMemoryUsageMB()
         base_start_time = time.perf_counter()
         push_thread = None
-        fom_check_duration = 0.0
+
+        # samples are aligned to multiples of the sampling interval; periodic push and FOM
+        # checks are scheduled against the same deadlines
+        scheduler = DeadlineScheduler(interval_secs)
+        push_frequency_ns = int(push_frequency_secs * 1e9)
+        fom_check_frequency_ns = int(self.__fomCheckFrequencySecs * 1e9)
+        if self.__spool:
+            self.__spool.start()
+        if self.__burstEnabled:
+            self.startBurst(monitor, interval_secs)
+        deadline_ns = scheduler.start()
+        next_push_ns = deadline_ns + push_frequency_ns
+        if self.__rollup:
+            next_rollup_ns = self.__rollup.next_boundary(deadline_ns)
+        next_fom_check_ns = deadline_ns + fom_check_frequency_ns
 
         # ---
         # main sampling loop
         try:
             while not terminateFlagEvent.is_set():
                 start_time = time.perf_counter()
-                timestamp_msecs = int(datetime.now(timezone.utc).timestamp() * 1000.0)
-                monitor.updateAllMetrics()
+                timestamp_msecs = deadline_ns // 1000000
+                monitor.updateCollectors()
                 self.getMetrics(timestamp_msecs)
+                if self.__burst:
+                    num_burst_samples += self.getBurstData()
+                if self.__rollup and deadline_ns >= next_rollup_ns:
+                    next_rollup_ns = self.__rollup.next_boundary(deadline_ns)
+                    num_rollup_samples += self.__rollup.flush(self.appendRollupSample)
                 num_samples += 1
                 sample_duration += time.perf_counter() - start_time
 
+                # size sample storage for a full push interval once samples/tick is known
+                if num_samples == 1:
+                    if self.__rollup:
+                        # mean, min, max, and last per series and window
+                        windows = push_frequency_ns // self.__rollup.window_ns + 1
+                        samples_per_push = 4 * self.__buffer.numSeries() * windows
+                    else:
+                        samples_per_push = len(self.__buffer) * int(push_frequency_secs / interval_secs + 1)
+                    # storage beyond max_reserve_mb grows geometrically as needed
+                    samples_per_push = min(samples_per_push, self.__maxReserveBytes // BYTES_PER_SAMPLE)
+                    self.__buffer.reserve(samples_per_push)
+                    logging.info(
+                        "Reserved sample storage for %i samples (%i series)"
+                        % (samples_per_push, self.__buffer.numSeries())
+                    )
+
                 # periodically push cached data to VictoriaMetrics
-                if push_check_duration > push_frequency_secs:
-                    push_check_duration = 0.0
+                if deadline_ns >= next_push_ns:
+                    next_push_ns = max(next_push_ns + push_frequency_ns, deadline_ns + 1)
                     # ensure previous push thread completed...
                     if push_thread is not None and push_thread.is_alive():
                         logging.info("Previous metric push is still running - blocking till complete.")
@@ -235,40 +608,28 @@ class Standalone:
                         logging.info("Resuming after previous metric push complete.")
                     try:
                         push_start_time = time.perf_counter()
-                        dataToPush = self.__dataVM
-                        push_thread = threading.Thread(
-                            target=push_to_victoria_metrics, args=(dataToPush, self.__victoriaURL)
-                        )
+                        dataToPush = self.__buffer.drain()
+                        self.expireSeries()
+                        push_thread = threading.Thread(target=self.pushSamples, args=(dataToPush,))
                         push_thread.start()
-                        self.__dataVM = []
                         num_pushes += 1
                         push_time_accumulation += time.perf_counter() - push_start_time
                     except:
                         pass
 
                 # periodically check for figure-of-merit (FOM) data
-                if fom_check_duration > self.__fomCheckFrequencySecs:
+                if deadline_ns >= next_fom_check_ns:
                     logging.debug("Checking on FOM data...")
-                    fom_check_duration = 0.0
+                    next_fom_check_ns = max(next_fom_check_ns + fom_check_frequency_ns, deadline_ns + 1)
                     if fomData:
-                        with fomLock:
-                            for entry in fomData:
-                                entry = '%s{instance="%s",name="%s"} %s %i' % (
-                                    "omnistat_fom",
-                                    self.__hostname,
-                                    entry["name"],
-                                    entry["value"],
-                                    entry["timestamp_msecs"],
-                                )
-                                self.__dataVM.append(entry)
-                            logging.info("Registered %i sample(s) of FOM data" % len(fomData))
-                            num_fom_samples += len(fomData)
-                            fomData.clear()
-
-                self.sleep_microsecs(interval_microsecs)
-                # time.sleep(interval_secs)
-                push_check_duration += time.perf_counter() - start_time
-                fom_check_duration += time.perf_counter() - start_time
+                        num_fom_samples += self.getFOMData()
+
+                # wait for next aligned sampling deadline
+                skipped = scheduler.wait()
+                if skipped:
+                    self.__overrunsCounter.inc()
+                    self.__missedDeadlinesCounter.inc(skipped)
+                deadline_ns = scheduler.deadline_ns
 
         except KeyboardInterrupt:
             logging.info("")
@@ -285,30 +646,33 @@ class Standalone:
             logging.info("Ready for final data dump after previous metric push complete.")
 
         # check for any remaining FOM data
+        if self.__fomSocket:
+            self.__fomSocket.stop()
         if fomData:
-            with fomLock:
-                for entry in fomData:
-                    entry = '%s{instance="%s",name="%s"} %s %i' % (
-                        "omnistat_fom",
-                        self.__hostname,
-                        entry["name"],
-                        entry["value"],
-                        entry["timestamp_msecs"],
-                    )
-                    self.__dataVM.append(entry)
-                logging.info("Registered %i sample(s) of FOM data" % len(fomData))
-                num_fom_samples += len(fomData)
-                fomData.clear()
+            num_fom_samples += self.getFOMData()
+
+        if self.__burst:
+            self.__burst.stop()
+            num_burst_samples += self.getBurstData()
+
+        if self.__rollup:
+            num_rollup_samples += self.__rollup.flush(self.appendRollupSample)
 
-        if len(self.__dataVM) > 0:
+        if len(self.__buffer) > 0:
             logging.info("Initiating final data push...")
-            push_to_victoria_metrics(self.__dataVM, self.__victoriaURL)
+            self.pushSamples(self.__buffer.drain())
+
+        if self.__spool:
+            logging.info("Delivering remaining spooled data (%i segment(s))..." % self.__spool.pending)
+            self.__spool.stop()
 
         logging.info("")
         logging.info("--> Sampling interval          = %.4f (secs)" % interval_secs)
         logging.info("--> Total # of samples         = %i" % num_samples)
         if num_samples > 0:
             logging.info("--> Average time/sample        = %.4f (secs)" % (sample_duration / num_samples))
+        logging.info("--> Sampling overruns          = %i" % scheduler.overruns)
+        logging.info("--> Missed sampling deadlines  = %i" % scheduler.missed)
         logging.info("--> Total data pushes          = %i" % num_pushes)
         if num_pushes > 0:
             logging.info("--> Average push duration      = %.4f (secs)" % (push_time_accumulation / num_pushes))
@@ -322,6 +686,17 @@ class Standalone:
         logging.info("--> Memory growth at stop      = %.3f MB" % (utils.getMemoryUsageMB() - mem_mb_base))
         if num_fom_samples > 0:
             logging.info("--> Total # of FOM samples     = %i" % num_fom_samples)
+        if self.__fomSocket:
+            logging.info("--> FOM samples via socket     = %i" % self.__fomSocket.received)
+        if self.__rollup:
+            logging.info("--> Total # of rollup samples  = %i" % num_rollup_samples)
+        if self.__burst:
+            logging.info("--> Burst regions requested    = %i" % self.__burst.regions)
+            logging.info("--> Total # of burst samples   = %i" % num_burst_samples)
+            logging.info("--> Burst region rows lost     = %i" % self.__burst.lost)
+        if self.__spool:
+            logging.info("--> Spooled segments delivered = %i" % self.__spool.delivered)
+            logging.info("--> Spooled segments dropped   = %i" % self.__spool.dropped)
 
         # deliver event to shutdown procedure
         logging.debug("setting shutdown delivery event")
@@ -348,91 +723,161 @@ def parse_args():
     parser.add_argument("--logfile", type=str, help="redirect stdout to logfile", default=None)
     parser.add_argument("--endpoint", type=str, help="hostname of VictoriaMetrics server", default="localhost")
     parser.add_argument("--port", type=int, help="port to access VictoriaMetrics server", default=9090)
+    parser.add_argument(
+        "--jobid",
+        type=str,
+        help="resource manager job ID (used to key the spool directory)",
+        default=os.getenv("SLURM_JOB_ID", os.getenv("FLUX_JOB_ID", os.getenv("PBS_JOBID", "local"))),
+    )
+    parser.add_argument("--startup-profile", help="report time spent in each startup phase", action="store_true")
 
     return parser.parse_args()
 
 
-@app.route("/shutdown")
-def terminate():
-    """Endpoint that can be used to terminate execution"""
-    logging.info("Received shutdown request")
-    terminateFlagEvent.set()
+def parseFOMSample(data, timestamp_msecs):
+    """Convert a {name, value[, timestamp_msecs]} request entry to a cached FOM sample"""
+    name = data.get("name")
+    if name is None:
+        raise ValueError("missing FOM name")
+    if data.get("timestamp_msecs") is not None:
+        timestamp_msecs = int(data["timestamp_msecs"])
+    return {"name": name, "value": data.get("value"), "timestamp_msecs": timestamp_msecs}
 
-    # spin loop till notice recieved that last data was pushed
-    maxChecks = 0
-    if "SAMPLING_INTERVAL" in app.config:
-        interval = app.config["SAMPLING_INTERVAL"]
-    else:
-        interval = 5.0
-    wait_interval = max(1, interval / 2.0)
-    while not dataDeliveredEvent.isSet():
-        logging.debug("waiting for data delivery event...(%.2f secs)" % wait_interval)
-        maxChecks += 1
-        if maxChecks > 10:
-            break
-        time.sleep(wait_interval)
-
-    return jsonify({"message": "Shutting down..."}), 200
-
-
-@app.errorhandler(403)
-def forbidden(e):
-    return jsonify(error="Access denied"), 403
-
-
-@app.route("/fom", methods=["POST"])
-def figureOfMerit():
-    """Endpoint that can be used by user to provide application figure of merit"""
-    try:
-        data = request.get_json()
-        name = data.get("name")
-        timestamp_msecs = int(datetime.now(timezone.utc).timestamp() * 1000.0)
-        value = data.get("value")
-        with fomLock:
-            fomData.append({"name": name, "value": value, "timestamp_msecs": timestamp_msecs})
-        return jsonify({"status": "ok"}), 200
 
-    except Exception as e:
-        return jsonify({"error": str(e)}), 400
+def createApp(config, samplingInterval):
+    """Create Flask app serving the exporter endpoints
 
+    Args:
+        config (configparser.ConfigParser): runtime configuration
+        samplingInterval (float): data sampling frequency (in secs)
 
-@app.route("/metrics")
-def heartbeat():
-    """Endpoint that can be used to confirm exporter is running"""
-    return jsonify({"status": "ok"}), 200
+    Returns:
+        flask.Flask: application
+    """
+    from flask import Flask, abort, jsonify, request
 
+    app = Flask(__name__)
 
-def runFlask(config):
+    # Enforce network restrictions
+    @app.before_request
+    def restrict_ips():
+        allowed_ips = config["omnistat.collectors"].get("allowed_ips", "127.0.0.1")
+        if "0.0.0.0" in allowed_ips:
+            return
+        elif request.remote_addr not in allowed_ips:
+            abort(403)
+
+    @app.route("/shutdown")
+    def terminate():
+        """Endpoint that can be used to terminate execution"""
+        logging.info("Received shutdown request")
+        terminateFlagEvent.set()
+
+        # spin loop till notice recieved that last data was pushed
+        maxChecks = 0
+        wait_interval = max(1, samplingInterval / 2.0)
+        while not dataDeliveredEvent.is_set():
+            logging.debug("waiting for data delivery event...(%.2f secs)" % wait_interval)
+            maxChecks += 1
+            if maxChecks > 10:
+                break
+            time.sleep(wait_interval)
+
+        return jsonify({"message": "Shutting down..."}), 200
+
+    @app.errorhandler(403)
+    def forbidden(e):
+        return jsonify(error="Access denied"), 403
+
+    @app.route("/fom", methods=["POST"])
+    def figureOfMerit():
+        """Endpoint that can be used by user to provide application figure of merit"""
+        try:
+            timestamp_msecs = int(datetime.now(timezone.utc).timestamp() * 1000.0)
+            sample = parseFOMSample(request.get_json(), timestamp_msecs)
+            with fomLock:
+                fomData.append(sample)
+            return jsonify({"status": "ok"}), 200
+
+        except Exception as e:
+            return jsonify({"error": str(e)}), 400
+
+    @app.route("/fom/batch", methods=["POST"])
+    def figureOfMeritBatch():
+        """Endpoint accepting a list of figure of merit samples, optionally with client-side timestamps (msecs)"""
+        try:
+            timestamp_msecs = int(datetime.now(timezone.utc).timestamp() * 1000.0)
+            data = request.get_json()
+            if isinstance(data, dict):
+                data = data.get("samples", [])
+            samples = [parseFOMSample(entry, timestamp_msecs) for entry in data]
+            deliverFOM(samples)
+            return jsonify({"status": "ok", "samples": len(samples)}), 200
+
+        except Exception as e:
+            return jsonify({"error": str(e)}), 400
+
+    @app.route("/burst", methods=["GET", "POST"])
+    def burst():
+        """Endpoint that can be used to start/stop a high-rate burst sampling region (mode=start|stop)"""
+        mode = request.args.get("mode")
+        if mode is None and request.is_json:
+            mode = request.get_json().get("mode")
+        if burstSampler is None:
+            return jsonify({"error": "burst mode not enabled"}), 400
+        if mode == "start":
+            burstSampler.begin()
+        elif mode == "stop":
+            burstSampler.end()
+        else:
+            return jsonify({"error": 'mode must be "start" or "stop"'}), 400
+        return jsonify({"status": "ok"}), 200
+
+    @app.route("/metrics")
+    def heartbeat():
+        """Endpoint that can be used to confirm exporter is running"""
+        return jsonify({"status": "ok"}), 200
+
+    return app
+
+
+def runFlask(app, config):
     listenPort = config["omnistat.collectors"].get("port", 8001)
     app.run(host="0.0.0.0", port=listenPort)
 
 
 def main():
+    profile = utils.startupProfile
+    elapsed = utils.processElapsedSecs()
+    if elapsed is not None:
+        profile.record("interpreter startup and imports", elapsed)
+
+    # preload Flask while collectors are initialized
+    flaskImport = threading.Thread(target=importlib.import_module, args=("flask",), daemon=True)
+    flaskImport.start()
 
     args = parse_args()
     config = utils.readConfig(utils.findConfigFile(args.configfile))
 
     # Initialize GPU monitoring
-    monitor = Monitor(config, logFile=args.logfile)
-    monitor.initMetrics()
+    with profile.phase("monitor initialization"):
+        monitor = Monitor(config, logFile=args.logfile)
+        monitor.initMetrics()
 
-    app.config["SAMPLING_INTERVAL"] = args.interval
+    with profile.phase("standalone setup"):
+        caching = Standalone(args, config)
 
-    caching = Standalone(args, config)
-
-    # Enforce network restrictions
-    @app.before_request
-    def restrict_ips():
-        allowed_ips = config["omnistat.collectors"].get("allowed_ips", "127.0.0.1")
-        if "0.0.0.0" in allowed_ips:
-            return
-        elif request.remote_addr not in allowed_ips:
-            abort(403)
+    with profile.phase("http endpoints setup"):
+        flaskImport.join()
+        app = createApp(config, args.interval)
 
     # Launch flask app as separate thread so we can respond to remote shutdown requests
-    flask_thread = threading.Thread(target=runFlask, args=[config])
+    flask_thread = threading.Thread(target=runFlask, args=[app, config])
     flask_thread.start()
 
+    if args.startup_profile:
+        profile.report()
+
     # Initiate main polling loop/data collection
     caching.polling(monitor, args.interval)
 
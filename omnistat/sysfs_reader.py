@@ -0,0 +1,77 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+
+"""Persistent sysfs file reader
+
+Telemetry files under /sys are opened once (typically during metric registration)
+and re-read on each sample with a single pread() at offset 0, which causes sysfs
+to regenerate the attribute contents. Compared to open()/read()/close() on every
+sample, this avoids the per-file open, fstat, and close system calls along with
+the Python file object allocation.
+"""
+
+import logging
+import os
+
+
+class SysfsReader:
+    def __init__(self, size=4096):
+        """
+        Args:
+            size (int): maximum number of bytes read per file (sysfs attributes are limited to a page)
+        """
+        self.__size = size
+        self.__fds = []
+        self.__paths = []
+
+    def __len__(self):
+        return len(self.__fds)
+
+    def open(self, path):
+        """Open a file for repeated reads; returns a handle for use with read() or None on error"""
+        try:
+            fd = os.open(path, os.O_RDONLY | os.O_CLOEXEC)
+        except OSError as e:
+            logging.debug("Unable to open %s (%s)" % (path, e))
+            return None
+        self.__fds.append(fd)
+        self.__paths.append(str(path))
+        return len(self.__fds) - 1
+
+    def path(self, handle):
+        return self.__paths[handle]
+
+    def read(self, handle):
+        """Return current contents of an opened file (or None on error)"""
+        try:
+            return os.pread(self.__fds[handle], self.__size, 0)
+        except OSError:
+            return None
+
+    def close(self):
+        for fd in self.__fds:
+            os.close(fd)
+        self.__fds = []
+        self.__paths = []
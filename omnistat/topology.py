@@ -0,0 +1,127 @@
+# -------------------------------------------------------------------------------
+# MIT License
+#
+# Copyright (c) 2023 - 2025 Advanced Micro Devices, Inc. All Rights Reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+# -------------------------------------------------------------------------------
+
+
+"""On-node cache of GPU topology discovered at exporter startup
+
+Mapping SMI device indices to HIP_VISIBLE_DEVICES indices and counting compute
+units requires reading KFD topology files for every GPU, and collectors issue
+several library queries per device for labels that do not change until the
+node is rebooted or the driver is reloaded. Collectors save these results in a
+small JSON file (one entry per collector) keyed by the boot ID, kernel release
+and amdgpu driver version, so later exporter launches on the same node can
+skip the discovery work. Entries are discarded when any part of the key
+changes.
+"""
+
+import json
+import logging
+import os
+import platform
+
+BOOT_ID_FILE = "/proc/sys/kernel/random/boot_id"
+DRIVER_VERSION_FILE = "/sys/module/amdgpu/version"
+CACHE_VERSION = 1
+
+
+def default_cache_path():
+    return "/tmp/omnistat_" + os.environ.get("USER", str(os.getuid())) + "_topology.json"
+
+
+def read_first_line(path):
+    try:
+        with open(path, "r") as f:
+            return f.readline().strip()
+    except OSError:
+        return ""
+
+
+def cache_key():
+    """Identify the current boot and driver; cached topology is only valid for a matching key"""
+    return {
+        "version": CACHE_VERSION,
+        "boot_id": read_first_line(BOOT_ID_FILE),
+        "kernel": platform.release(),
+        "amdgpu": read_first_line(DRIVER_VERSION_FILE),
+    }
+
+
+class TopologyCache:
+    def __init__(self, path, key=None):
+        self.__path = path
+        self.__key = key if key is not None else cache_key()
+        self.__entries = self.load()
+
+    @property
+    def path(self):
+        return self.__path
+
+    def load(self):
+        """Read entries saved for the current key (empty if missing, stale, or unreadable)"""
+        if not self.__path or not self.__key["boot_id"]:
+            return {}
+        try:
+            with open(self.__path, "r") as f:
+                data = json.load(f)
+        except FileNotFoundError:
+            return {}
+        except (OSError, ValueError) as e:
+            logging.warning("[WARN]: Ignoring unreadable topology cache %s (%s)" % (self.__path, e))
+            return {}
+        if data.get("key") != self.__key:
+            logging.info("Discarding topology cache from a different boot or driver version (%s)" % self.__path)
+            return {}
+        return data.get("entries", {})
+
+    def get(self, name):
+        """Cached entry for a collector, or None"""
+        return self.__entries.get(name)
+
+    def put(self, name, entry):
+        """Save entry for a collector, preserving entries saved by other collectors"""
+        if not self.__path or not self.__key["boot_id"]:
+            return
+        self.__entries = self.load()
+        self.__entries[name] = entry
+        tmpPath = "%s.%i.tmp" % (self.__path, os.getpid())
+        try:
+            fd = os.open(tmpPath, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o600)
+            with os.fdopen(fd, "w") as f:
+                json.dump({"key": self.__key, "entries": self.__entries}, f)
+            os.replace(tmpPath, self.__path)
+            logging.info("--> Saved %s topology to cache %s" % (name, self.__path))
+        except OSError as e:
+            logging.warning("[WARN]: Unable to save topology cache %s (%s)" % (self.__path, e))
+            try:
+                os.unlink(tmpPath)
+            except OSError:
+                pass
+
+
+def open_cache(runtimeConfig):
+    """Topology cache configured for collectors (None when disabled)"""
+    path = runtimeConfig.get("collector_topology_cache")
+    if not path:
+        return None
+    return TopologyCache(path)
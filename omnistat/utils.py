@@ -25,6 +25,7 @@
 import argparse
 import concurrent.futures
 import configparser
+import contextlib
 import importlib.resources
 import logging
 import os
@@ -33,6 +34,7 @@ import resource
 import shutil
 import subprocess
 import sys
+import threading
 import time
 from importlib.metadata import version
 from pathlib import Path
@@ -187,7 +189,8 @@ def gpu_index_mapping_based_on_bdfs(bdfMapping, expectedNumGPUs):
 def count_compute_units(nodes):
     """
     Count the number of compute units for each one of the given GPU node IDs
-    (KFD internal GPU indices).
+    (KFD internal GPU indices). Properties files of all nodes are read
+    concurrently.
 
     Args:
         nodes (list): list of GPU node IDs to calculate the number of CUs for.
@@ -198,8 +201,7 @@ def count_compute_units(nodes):
     base_path = Path("/sys/class/kfd/kfd/topology/nodes")
     pattern = re.compile(r"^(simd_count|simd_per_cu)\s+(\d+)", re.MULTILINE)
 
-    compute_units = {}
-    for node in nodes:
+    def read_compute_units(node):
         # The properties file should contain simd_count and simd_per_cu
         # values, which can be used to calculate the number of CUs. Abort the
         # execution if there are issues opening the file or if simd values
@@ -216,35 +218,79 @@ def count_compute_units(nodes):
                 value = int(match.group(2))
                 simd_values[key] = value
 
-            compute_units[node] = simd_values["simd_count"] / simd_values["simd_per_cu"]
+            return simd_values["simd_count"] / simd_values["simd_per_cu"]
         except:
             logging.error(f"ERROR: Failed to read node properties file {properties}.")
             sys.exit(4)
 
-    return compute_units
+    nodes = list(nodes)
+    return dict(zip(nodes, probe_concurrently(read_compute_units, nodes)))
 
 
-def get_occupancy(guid):
-    """
-    Get aggregated CU occupancy for all the processes running in a given GPU
-    device ID (guid).
+def probe_concurrently(function, items, max_workers=16):
+    """Apply function to all items using a pool of threads (e.g. device queries at startup)
 
     Args:
-        guid (int): GPU device ID.
+        function (callable): function applied to each item
+        items (list): items to probe
+        max_workers (int): maximum number of concurrent calls
 
     Returns:
-        int: CU occupancy in number of CUs.
+        list: results, in the same order as items
     """
-    base_path = Path("/sys/class/kfd/kfd/proc")
-    file_pattern = f"*/stats_{guid}/cu_occupancy"
+    items = list(items)
+    if len(items) <= 1:
+        return [function(item) for item in items]
+    with concurrent.futures.ThreadPoolExecutor(max_workers=min(len(items), max_workers)) as executor:
+        return list(executor.map(function, items))
+
+
+class StartupProfile:
+    """Wall-clock time spent in named phases of exporter startup (reported with --startup-profile)"""
+
+    def __init__(self):
+        self.__phases = []
+        self.__lock = threading.Lock()
+
+    @contextlib.contextmanager
+    def phase(self, name):
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.record(name, time.perf_counter() - start)
+
+    def record(self, name, secs):
+        with self.__lock:
+            self.__phases.append((time.perf_counter() - secs, name, secs))
+
+    def report(self):
+        """Log phases in the order they started (phases may be nested)"""
+        logging.info("Startup profile:")
+        with self.__lock:
+            phases = sorted(self.__phases)
+        for _, name, secs in phases:
+            logging.info("--> %-44s = %.4f (secs)" % (name, secs))
+        elapsed = processElapsedSecs()
+        if elapsed is not None:
+            logging.info("--> %-44s = %.4f (secs)" % ("total since process start", elapsed))
+
+
+def processElapsedSecs():
+    """Wall-clock time since the current process was started (None if unavailable)"""
+    try:
+        with open("/proc/self/stat") as f:
+            # fields following the executable name, which may contain spaces
+            fields = f.read().rsplit(")", 1)[1].split()
+        with open("/proc/uptime") as f:
+            uptime = float(f.readline().split()[0])
+        return uptime - int(fields[19]) / os.sysconf("SC_CLK_TCK")
+    except (OSError, ValueError, IndexError):
+        return None
 
-    cu_occupancy = 0
-    for cu_file in list(base_path.glob(file_pattern)):
-        with open(cu_file, "r") as f:
-            data = f.read().strip()
-        cu_occupancy += int(data)
 
-    return cu_occupancy
+# phases recorded during startup of the current process
+startupProfile = StartupProfile()
 
 
 def error(message):
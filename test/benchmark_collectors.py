@@ -0,0 +1,373 @@
+"""
+Collector overhead benchmarks.
+
+Drives each data collector through registerMetrics() and updateMetrics()
+against mock device libraries and sysfs trees (see mock_devices.py), across
+GPU counts, NIC counts, and sampling intervals, and reports for each case:
+ - update latency percentiles (p50/p90/p99/max, in microseconds)
+ - memory allocated per update (peak traced bytes) and retained per update
+   (traced bytes and allocated blocks), measured with tracemalloc in a
+   separate pass so that tracing does not skew latencies
+ - size of the text exposition served to Prometheus and the time to render it
+
+Results can be saved as a JSON baseline and compared against in later runs;
+the comparison exits with a non-zero status if latency or allocations regress
+by more than the given tolerance. For example, from the root directory of the
+project:
+
+    python -m test.benchmark_collectors --output baseline.json
+    python -m test.benchmark_collectors --baseline baseline.json --tolerance 0.25
+
+No GPUs or ROCm installation are required. Latencies measure the Python-side
+cost of the collectors (mock library calls return immediately) and are only
+comparable between runs on the same host.
+"""
+
+import argparse
+import configparser
+import ctypes
+import gc
+import json
+import logging
+import platform
+import sys
+import time
+import tracemalloc
+from unittest import mock
+
+from test.mock_devices import NUM_CUS, MockAMDSMI, MockROCmSMI, MockSysfs
+
+# install mock amdsmi before collectors are imported
+amdsmi = MockAMDSMI()
+
+from prometheus_client import REGISTRY, generate_latest
+
+from omnistat import occupancy
+from omnistat.monitor import Monitor
+from omnistat.scheduler import DeadlineScheduler
+
+# latency and allocation metrics compared against baselines
+LATENCY_KEYS = ["latency_p50_us", "latency_p99_us"]
+ALLOCATION_KEYS = ["alloc_peak_bytes", "retained_bytes"]
+
+# differences below these thresholds are ignored in comparisons (timer and allocator noise)
+MIN_LATENCY_DIFF_US = 5.0
+MIN_ALLOCATION_DIFF_BYTES = 256
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    index = min(len(ordered) - 1, max(0, int(round(fraction * (len(ordered) - 1)))))
+    return ordered[index]
+
+
+def clear_registry():
+    for collector in list(REGISTRY._collector_to_names):
+        REGISTRY.unregister(collector)
+
+
+def runtime_config(options, sysfs):
+    """Runtime configuration as parsed by Monitor, with all collectors disabled unless enabled in options"""
+    config = configparser.ConfigParser()
+    config["omnistat.collectors"] = {
+        "enable_rocm_smi": "False",
+        "enable_amd_smi": "False",
+        "enable_network": "False",
+        "enable_ras_ecc": "True",
+        # mock devices must not be cached as the topology of the local node
+        "enable_topology_cache": "False",
+    }
+    config["omnistat.collectors"].update(options)
+    jobFile, stepFile = sysfs.add_job()
+    config["omnistat.collectors.rms"] = {"job_detection_file": jobFile, "step_detection_file": stepFile}
+    monitor = Monitor(config)
+    return monitor.runtimeConfig, getattr(monitor, "jobDetection", None)
+
+
+def mock_occupancy(module, sysfs, guids, processes_per_gpu):
+    """Serve CU counts and KFD process occupancy from the mock tree"""
+    module.count_compute_units = lambda nodes: {node: NUM_CUS for node in nodes}
+    base = sysfs.add_kfd_processes(guids, processes_per_gpu)
+    occupancy._shared = occupancy.OccupancyScanner(guids, base_path=base)
+
+
+# --------------------------------------------------------------------------------------
+# Collector factories: (config options, MockSysfs, case) -> collector
+
+
+def network(options, sysfs, case):
+    import omnistat.collector_network as module
+
+    sysfs.add_nics(case["nics"], num_cxi=case["nics"] // 2, num_ib=case["nics"] // 2)
+    sysfs.redirect(module)
+    runtimeConfig, jobDetection = runtime_config(options, sysfs)
+    return module.NETWORK(runtimeConfig=runtimeConfig)
+
+
+def vendor_counters(options, sysfs, case):
+    import omnistat.collector_pm_counters as module
+
+    path = sysfs.add_pm_counters(case["gpus"])
+    collector = module.PM_COUNTERS()
+    collector._PM_COUNTERS__pm_counter_dir = path
+    return collector
+
+
+def rms(options, sysfs, case):
+    from omnistat.collector_rms import RMSJob
+
+    runtimeConfig, jobDetection = runtime_config(options, sysfs)
+    return RMSJob(annotations=runtimeConfig["rms_collector_annotations"], jobDetection=jobDetection)
+
+
+def rocm_smi(options, sysfs, case):
+    import omnistat.collector_smi as module
+
+    sysfs.write("/opt/rocm/lib/librocm_smi64.so", "")
+    options = dict(options, rocm_path=sysfs.path("/opt/rocm"))
+    runtimeConfig, jobDetection = runtime_config(options, sysfs)
+    if runtimeConfig["collector_cu_occupancy"]:
+        guids = [10000 + gpu for gpu in range(case["gpus"])]
+        mock_occupancy(module, sysfs, guids, case["processes"])
+    with mock.patch.object(ctypes, "CDLL", MockROCmSMI(case["gpus"])):
+        return module.ROCMSMI(runtimeConfig=runtimeConfig)
+
+
+def amd_smi(options, sysfs, case):
+    import omnistat.collector_smi_v2 as module
+
+    amdsmi.configure(case["gpus"], case["processes"])
+    runtimeConfig, jobDetection = runtime_config(options, sysfs)
+    if runtimeConfig["collector_cu_occupancy"]:
+        guids = [amdsmi.guid(gpu) for gpu in range(case["gpus"])]
+        mock_occupancy(module, sysfs, guids, case["processes"])
+    return module.AMDSMI(runtimeConfig=runtimeConfig)
+
+
+def amd_smi_process(options, sysfs, case):
+    from omnistat.collector_smi_process import AMDSMIProcess
+
+    amdsmi.configure(case["gpus"], case["processes"])
+    runtimeConfig, jobDetection = runtime_config(options, sysfs)
+    return AMDSMIProcess(runtimeConfig=runtimeConfig)
+
+
+def events(options, sysfs, case):
+    from omnistat.collector_events import ROCMEvents
+
+    amdsmi.configure(case["gpus"])
+    amdsmi.stopping.clear()
+    runtimeConfig, jobDetection = runtime_config(options, sysfs)
+    return ROCMEvents(runtimeConfig=runtimeConfig)
+
+
+# name -> (factory, config options, dimension the case is varied across)
+COLLECTORS = {
+    "network": (network, {"enable_network": "True"}, "nics"),
+    "network_rates": (network, {"enable_network": "True", "enable_network_rates": "True"}, "nics"),
+    "vendor_counters": (vendor_counters, {}, "gpus"),
+    "rms": (rms, {"enable_rms": "True"}, None),
+    "rocm_smi": (rocm_smi, {"enable_rocm_smi": "True"}, "gpus"),
+    "rocm_smi_queries": (rocm_smi, {"enable_rocm_smi": "True", "enable_smi_metrics_table": "False"}, "gpus"),
+    "rocm_smi_occupancy": (rocm_smi, {"enable_rocm_smi": "True", "enable_cu_occupancy": "True"}, "gpus"),
+    "amd_smi": (amd_smi, {"enable_amd_smi": "True"}, "gpus"),
+    "amd_smi_sweep": (amd_smi, {"enable_amd_smi": "True", "enable_amd_smi_sweep": "True"}, "gpus"),
+    "amd_smi_occupancy": (amd_smi, {"enable_amd_smi": "True", "enable_cu_occupancy": "True"}, "gpus"),
+    "amd_smi_process": (amd_smi_process, {"enable_amd_smi_process": "True"}, "gpus"),
+    "events": (events, {"enable_events": "True"}, "gpus"),
+}
+
+
+def run_case(name, case, samples, interval):
+    factory, options, dimension = COLLECTORS[name]
+    clear_registry()
+    occupancy._shared = None
+    sysfs = MockSysfs()
+    try:
+        start = time.perf_counter()
+        collector = factory(options, sysfs, case)
+        collector.registerMetrics()
+        register_secs = time.perf_counter() - start
+
+        # warm up caches and lazily-created label children
+        for i in range(3):
+            collector.updateMetrics()
+
+        # latency pass (paced at the sampling interval when given)
+        gc.collect()
+        latencies = []
+        scheduler = DeadlineScheduler(interval) if interval > 0 else None
+        if scheduler:
+            scheduler.start()
+        for i in range(samples):
+            start = time.perf_counter_ns()
+            collector.updateMetrics()
+            latencies.append((time.perf_counter_ns() - start) / 1000.0)
+            if scheduler:
+                scheduler.wait()
+
+        # allocation pass
+        allocations = max(10, samples // 10)
+        tracemalloc.start()
+        collector.updateMetrics()
+        peaks = []
+        gc.collect()
+        retainedStart = tracemalloc.get_traced_memory()[0]
+        blocksStart = sys.getallocatedblocks()
+        for i in range(allocations):
+            current = tracemalloc.get_traced_memory()[0]
+            if hasattr(tracemalloc, "reset_peak"):
+                tracemalloc.reset_peak()
+            collector.updateMetrics()
+            peaks.append(tracemalloc.get_traced_memory()[1] - current)
+        gc.collect()
+        retained = (tracemalloc.get_traced_memory()[0] - retainedStart) / allocations
+        blocks = (sys.getallocatedblocks() - blocksStart) / allocations
+        tracemalloc.stop()
+
+        # exposition of this collector's metrics
+        text = generate_latest(REGISTRY)
+        start = time.perf_counter()
+        for i in range(10):
+            generate_latest(REGISTRY)
+        render_us = (time.perf_counter() - start) / 10 * 1e6
+
+        if hasattr(collector, "stop"):
+            amdsmi.stopping.set()
+            collector.stop()
+    finally:
+        sysfs.cleanup()
+
+    series = [line for line in text.decode().splitlines() if line and not line.startswith("#")]
+    return {
+        "register_ms": round(register_secs * 1000, 3),
+        "latency_p50_us": round(percentile(latencies, 0.50), 2),
+        "latency_p90_us": round(percentile(latencies, 0.90), 2),
+        "latency_p99_us": round(percentile(latencies, 0.99), 2),
+        "latency_max_us": round(max(latencies), 2),
+        "alloc_peak_bytes": int(percentile(peaks, 0.50)) if hasattr(tracemalloc, "reset_peak") else None,
+        "retained_bytes": round(retained, 1),
+        "retained_blocks": round(blocks, 2),
+        "exposition_bytes": len(text),
+        "exposition_series": len(series),
+        "render_us": round(render_us, 2),
+    }
+
+
+def case_matrix(names, gpus, nics, processes, intervals):
+    """Yield (key, collector, case, interval) for each benchmark case"""
+    for name in names:
+        dimension = COLLECTORS[name][2]
+        if dimension == "gpus":
+            values = gpus
+        elif dimension == "nics":
+            values = nics
+        else:
+            values = [None]
+        for value in values:
+            case = {"gpus": gpus[-1], "nics": nics[-1], "processes": processes}
+            label = name
+            if dimension:
+                case[dimension] = value
+                label += "/%s=%i" % (dimension, value)
+            for interval in intervals:
+                key = label + ("/interval=%g" % interval if interval > 0 else "")
+                yield key, name, case, interval
+
+
+def compare(results, baseline, tolerance):
+    """Report differences against a baseline; returns number of regressions"""
+    regressions = 0
+    for key, result in results.items():
+        base = baseline.get(key)
+        if base is None:
+            print("  %-44s (new case)" % key)
+            continue
+        for metric in LATENCY_KEYS + ALLOCATION_KEYS:
+            value, reference = result.get(metric), base.get(metric)
+            if value is None or reference is None:
+                continue
+            threshold = MIN_LATENCY_DIFF_US if metric in LATENCY_KEYS else MIN_ALLOCATION_DIFF_BYTES
+            if value > reference * (1 + tolerance) and value - reference > threshold:
+                regressions += 1
+                print("  %-44s %-18s %10.1f -> %10.1f  REGRESSION" % (key, metric, reference, value))
+            elif value < reference * (1 - tolerance) and reference - value > threshold:
+                print("  %-44s %-18s %10.1f -> %10.1f  improved" % (key, metric, reference, value))
+        if result["exposition_series"] != base.get("exposition_series"):
+            print(
+                "  %-44s %-18s %10s -> %10s  changed"
+                % (key, "exposition_series", base.get("exposition_series"), result["exposition_series"])
+            )
+    return regressions
+
+
+def parse_list(value, type=int):
+    return [type(entry) for entry in value.split(",") if entry]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark Omnistat collector overhead with mock devices")
+    parser.add_argument("--collectors", type=str, default=",".join(COLLECTORS), help="collectors to benchmark")
+    parser.add_argument("--gpus", type=str, default="1,4,8", help="GPU counts (comma separated)")
+    parser.add_argument("--nics", type=str, default="1,4", help="NIC counts (comma separated)")
+    parser.add_argument("--processes", type=int, default=4, help="GPU processes per GPU")
+    parser.add_argument("--intervals", type=str, default="0", help="sampling intervals in secs (0 = back to back)")
+    parser.add_argument("--samples", type=int, default=200, help="number of timed updates per case")
+    parser.add_argument("--output", type=str, help="write results (JSON) to file, e.g. to use as baseline")
+    parser.add_argument("--baseline", type=str, help="compare against results from a previous run")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="relative regression tolerance")
+    parser.add_argument("--verbose", action="store_true", help="show collector log messages")
+    args = parser.parse_args()
+
+    logging.basicConfig(format="%(message)s", level=logging.INFO if args.verbose else logging.ERROR)
+
+    names = parse_list(args.collectors, str)
+    for name in names:
+        if name not in COLLECTORS:
+            parser.error("unknown collector %s (available: %s)" % (name, ", ".join(COLLECTORS)))
+    gpus = parse_list(args.gpus)
+    nics = parse_list(args.nics)
+    intervals = parse_list(args.intervals, float)
+
+    header = "%-44s %9s %9s %9s %9s %10s %10s %8s %7s %9s"
+    print(header % ("case", "p50 us", "p90 us", "p99 us", "max us", "peak B", "kept B", "exp B", "series", "render"))
+    results = {}
+    for key, name, case, interval in case_matrix(names, gpus, nics, args.processes, intervals):
+        result = run_case(name, case, args.samples, interval)
+        results[key] = result
+        print(
+            "%-44s %9.1f %9.1f %9.1f %9.1f %10s %10.1f %8i %7i %9.1f"
+            % (
+                key,
+                result["latency_p50_us"],
+                result["latency_p90_us"],
+                result["latency_p99_us"],
+                result["latency_max_us"],
+                result["alloc_peak_bytes"],
+                result["retained_bytes"],
+                result["exposition_bytes"],
+                result["exposition_series"],
+                result["render_us"],
+            )
+        )
+
+    if args.output:
+        environment = {"python": platform.python_version(), "host": platform.node(), "samples": args.samples}
+        with open(args.output, "w") as f:
+            json.dump({"environment": environment, "cases": results}, f, indent=2)
+            f.write("\n")
+        print("\nResults written to %s" % args.output)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)["cases"]
+        print("\nComparison against %s (tolerance = %.0f%%):" % (args.baseline, args.tolerance * 100))
+        regressions = compare(results, baseline, args.tolerance)
+        print("--> %i regression(s)" % regressions)
+        if regressions:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
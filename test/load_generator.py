@@ -0,0 +1,462 @@
+"""
+Synthetic large-scale load generator for query and storage benchmarking.
+
+Streams synthetic Omnistat telemetry for a single job (e.g. 1000-4000 nodes
+over multiple days) into VictoriaMetrics, and times the end-to-end
+`omnistat-query` report and export for that job. Unlike TraceGenerator (see
+trace_generator.py), samples are never held in memory for the whole trace:
+each worker process generates the series of a subset of nodes, one series at
+a time, and pushes them in bounded chunks with the same encoding used by
+user-mode Omnistat.
+
+Every node exports the series scraped from a real node:
+ - rmsjob_info (split into --steps job steps) and rocm_num_gpus
+ - GPU metrics reported by omnistat-query (GPU_METRIC_NAMES) for each GPU
+ - omnistat_network_{rx,tx}_bytes for each NIC
+ - omnistat_vendor_* energy counters (--vendor)
+ - amdsmi_process_{vram,compute} for --processes processes per GPU
+ - omnistat_rocprofiler for --counters counters per GPU
+ - rmsjob_annotations for --annotations markers over the job
+
+Values follow deterministic pseudo-random patterns (seeded by node), and
+cumulative counters increase monotonically, so storage compression and query
+results are comparable across runs. For example, using the VictoriaMetrics
+container from test/docker/victoriametrics, from the root directory of the
+project:
+
+    python -m test.load_generator --nodes 1000 --gpus 8 --duration 2d --interval 10
+    python -m test.load_generator --job <job-id> --skip-ingest --nodes 1000 --duration 2d --interval 10
+
+Use --dry-run to measure generator throughput (and the number of samples and
+bytes for a given configuration) without a server.
+"""
+
+import argparse
+import contextlib
+import io
+import json
+import logging
+import math
+import os
+import sys
+import tempfile
+import time
+import timeit
+import uuid
+from concurrent.futures import ProcessPoolExecutor, as_completed
+from pathlib import Path
+
+import numpy as np
+import requests
+
+from omnistat.standalone import encode_metric_chunks, post_metric_chunk
+from omnistat.utils import readConfig
+from test.trace_generator import GPU_METRIC_NAMES
+
+test_path = Path(__file__).resolve().parent
+CONFIG_FILE = f"{test_path}/docker/victoriametrics/omnistat-query.config"
+
+# Range of values for each GPU metric (min, max)
+GPU_METRIC_RANGES = {
+    "rocm_utilization_percentage": (0.0, 100.0),
+    "rocm_vram_used_percentage": (0.0, 100.0),
+    "rocm_temperature_celsius": (30.0, 95.0),
+    "rocm_sclk_clock_mhz": (500.0, 2100.0),
+    "rocm_average_socket_power_watts": (90.0, 750.0),
+}
+
+# Node-level vendor counters (rate in joules/sec) and per-GPU accelerator counter
+VENDOR_NODE_METRICS = {
+    "omnistat_vendor_energy_joules": 2500.0,
+    "omnistat_vendor_memory_energy_joules": 150.0,
+    "omnistat_vendor_cpu_energy_joules": 300.0,
+}
+VENDOR_GPU_METRIC = "omnistat_vendor_accel_energy_joules"
+
+DURATION_UNITS = {"s": 1, "m": 60, "h": 3600, "d": 86400}
+
+
+def parse_duration(value):
+    """Duration in seconds from a number with an optional unit suffix (e.g. 90, 30m, 12h, 3d)"""
+    value = value.strip()
+    if value and value[-1] in DURATION_UNITS:
+        return float(value[:-1]) * DURATION_UNITS[value[-1]]
+    return float(value)
+
+
+class SyntheticJob:
+    """
+    Synthetic job telemetry, generated lazily per node and series.
+
+    All nodes share the same sample timestamps, which end roughly at the
+    current time (the job is generated as if it ran over the last `duration`
+    seconds).
+    """
+
+    def __init__(
+        self,
+        job_id,
+        num_nodes,
+        num_gpus,
+        num_nics,
+        duration,
+        interval,
+        processes=0,
+        counters=0,
+        annotations=0,
+        steps=0,
+        vendor=False,
+        seed=0,
+        end_time=None,
+    ):
+        self.job_id = str(job_id)
+        self.num_nodes = num_nodes
+        self.num_gpus = num_gpus
+        self.num_nics = num_nics
+        self.duration = duration
+        self.interval = interval
+        self.processes = processes
+        self.counters = counters
+        self.annotations = annotations
+        self.steps = steps
+        self.vendor = vendor
+        self.seed = seed
+
+        if end_time is None:
+            end_time = int(time.time())
+        self.end_time = end_time
+        self.num_samples = int(duration // interval) + 1
+        self.start_time = end_time - (self.num_samples - 1) * interval
+
+    def params(self):
+        """Constructor arguments, used to recreate the job in worker processes"""
+        return {
+            "job_id": self.job_id,
+            "num_nodes": self.num_nodes,
+            "num_gpus": self.num_gpus,
+            "num_nics": self.num_nics,
+            "duration": self.duration,
+            "interval": self.interval,
+            "processes": self.processes,
+            "counters": self.counters,
+            "annotations": self.annotations,
+            "steps": self.steps,
+            "vendor": self.vendor,
+            "seed": self.seed,
+            "end_time": self.end_time,
+        }
+
+    def node_name(self, node):
+        return f"node{node:05d}"
+
+    def series_per_node(self):
+        num_series = 2 + self.num_gpus * len(GPU_METRIC_NAMES) + 2 * self.num_nics
+        if self.vendor:
+            num_series += len(VENDOR_NODE_METRICS) + self.num_gpus
+        num_series += self.num_gpus * (2 * self.processes + self.counters)
+        return num_series
+
+    def samples_per_node(self):
+        # Annotations are only present while each marker is active
+        annotation_samples = 0
+        if self.annotations > 0:
+            annotation_samples = self.annotations * (self.num_samples // (2 * self.annotations))
+        return self.series_per_node() * self.num_samples + annotation_samples
+
+    def total_samples(self):
+        return self.num_nodes * self.samples_per_node()
+
+    def times(self):
+        """Sample timestamps (msecs) formatted for the text exposition"""
+        interval_msecs = int(self.interval * 1000)
+        return [str(int(self.start_time * 1000) + i * interval_msecs) for i in range(self.num_samples)]
+
+    def samples(self, node, times=None):
+        """
+        Generator providing all samples for a node in Prometheus text
+        exposition format, one series at a time.
+
+        Args:
+            node (int): Node index within the job.
+            times (list): Formatted timestamps, reused across nodes (optional).
+        """
+        if times is None:
+            times = self.times()
+        num_samples = len(times)
+        rng = np.random.default_rng([self.seed, node])
+        instance = f'instance="{self.node_name(node)}"'
+        phase = np.linspace(0.0, 2 * math.pi * max(1.0, self.duration / 3600.0), num_samples)
+
+        # Job info, with samples assigned to consecutive steps when requested
+        info_labels = f'{instance},jobid="{self.job_id}",nodes="{self.num_nodes}",partition="test",user="omnistat"'
+        info_labels += ',batchflag="1",type="slurm"'
+        if self.steps > 0:
+            step_length = max(1, num_samples // self.steps)
+            for i, t in enumerate(times):
+                step = min(i // step_length, self.steps - 1)
+                yield f'rmsjob_info{{{info_labels},jobstep="{step}"}} 1 {t}'
+        else:
+            for t in times:
+                yield f'rmsjob_info{{{info_labels},jobstep="-1"}} 1 {t}'
+
+        for t in times:
+            yield f"rocm_num_gpus{{{instance}}} {self.num_gpus} {t}"
+
+        # Annotations are active for the first half of each segment of the job
+        if self.annotations > 0:
+            segment = num_samples // self.annotations
+            for marker in range(self.annotations):
+                start = marker * segment
+                labels = f'{instance},jobid="{self.job_id}",marker="annotation-{marker}"'
+                for t in times[start : start + segment // 2]:
+                    yield f"rmsjob_annotations{{{labels}}} 1 {t}"
+
+        for gpu in range(self.num_gpus):
+            card = f'card="{gpu}"'
+            for name in GPU_METRIC_NAMES:
+                low, high = GPU_METRIC_RANGES[name]
+                yield from self._series(f"{name}{{{instance},{card}}}", self._wave(rng, phase, low, high), times)
+
+        for nic in range(self.num_nics):
+            for direction in ("rx", "tx"):
+                labels = f'{instance},device_class="cxi",interface="cxi{nic}"'
+                rates = rng.uniform(1e8, 2.5e10, num_samples) * self.interval
+                yield from self._series(f"omnistat_network_{direction}_bytes{{{labels}}}", np.cumsum(rates), times, 0)
+
+        if self.vendor:
+            vendor = 'vendor="cray"'
+            for name, rate in VENDOR_NODE_METRICS.items():
+                energy = np.cumsum(self._wave(rng, phase, 0.5 * rate, rate) * self.interval)
+                yield from self._series(f"{name}{{{instance},{vendor}}}", energy, times, 0)
+            for gpu in range(self.num_gpus):
+                energy = np.cumsum(self._wave(rng, phase, 90.0, 750.0) * self.interval)
+                yield from self._series(f'{VENDOR_GPU_METRIC}{{{instance},card="{gpu}",{vendor}}}', energy, times, 0)
+
+        for gpu in range(self.num_gpus):
+            for process in range(self.processes):
+                pid = 10000 + gpu * self.processes + process
+                labels = f'{instance},card="{gpu}",name="app",pid="{pid}"'
+                vram = np.full(num_samples, float(rng.integers(1, 64) * 2**30))
+                yield from self._series(f"amdsmi_process_vram{{{labels}}}", vram, times, 0)
+                compute = np.full(num_samples, float(rng.integers(1, 100)))
+                yield from self._series(f"amdsmi_process_compute{{{labels}}}", compute, times, 0)
+
+        for gpu in range(self.num_gpus):
+            for counter in range(self.counters):
+                labels = f'{instance},card="{gpu}",counter="COUNTER_{counter}"'
+                values = rng.integers(0, 2**32, num_samples).astype(float)
+                yield from self._series(f"omnistat_rocprofiler{{{labels}}}", values, times, 0)
+
+    def _wave(self, rng, phase, low, high):
+        """Periodic load with noise, bounded by low and high"""
+        center = rng.uniform(low, high)
+        amplitude = rng.uniform(0.0, 0.25) * (high - low)
+        noise = rng.normal(0.0, 0.02 * (high - low), len(phase))
+        values = center + amplitude * np.sin(phase + rng.uniform(0.0, 2 * math.pi)) + noise
+        return np.clip(values, low, high)
+
+    def _series(self, metric, values, times, decimals=1):
+        for v, t in zip(np.round(values, decimals).tolist(), times):
+            yield f"{metric} {v} {t}"
+
+
+def push_nodes(params, nodes, url, chunk_samples, compression, retries):
+    """
+    Generate and push samples for a subset of nodes (runs in worker processes).
+
+    Returns:
+        tuple: (# of samples, # of payload bytes, # of samples dropped)
+    """
+    job = SyntheticJob(**params)
+    times = job.times()
+    headers = {"Content-Type": "text/plain"}
+    if compression == "gzip":
+        headers["Content-Encoding"] = "gzip"
+
+    num_samples = 0
+    num_bytes = 0
+    dropped = 0
+    for node in nodes:
+        for payload, samples in encode_metric_chunks(job.samples(node, times), chunk_samples, compression):
+            num_samples += samples
+            num_bytes += len(payload)
+            if url is None:
+                continue
+            if not post_metric_chunk(url, payload, headers, retries):
+                dropped += samples
+    return num_samples, num_bytes, dropped
+
+
+def ingest(job, url, workers, nodes_per_task, chunk_samples, compression, retries):
+    """Push all nodes in the job with a pool of worker processes (url=None generates without pushing)"""
+    tasks = [list(range(i, min(i + nodes_per_task, job.num_nodes))) for i in range(0, job.num_nodes, nodes_per_task)]
+    results = {"samples": 0, "bytes": 0, "dropped": 0}
+    done = 0
+    start = timeit.default_timer()
+    with ProcessPoolExecutor(max_workers=workers) as executor:
+        futures = [
+            executor.submit(push_nodes, job.params(), nodes, url, chunk_samples, compression, retries)
+            for nodes in tasks
+        ]
+        for future in as_completed(futures):
+            samples, num_bytes, dropped = future.result()
+            results["samples"] += samples
+            results["bytes"] += num_bytes
+            results["dropped"] += dropped
+            done += 1
+            elapsed = timeit.default_timer() - start
+            logging.info(
+                "Ingested %i/%i tasks: %i samples in %.1f secs (%.0f samples/sec)"
+                % (done, len(tasks), results["samples"], elapsed, results["samples"] / elapsed)
+            )
+    results["secs"] = timeit.default_timer() - start
+    results["samples_per_sec"] = results["samples"] / results["secs"]
+
+    if url is not None:
+        # Make recently ingested samples visible to queries
+        try:
+            requests.get(url + "/internal/force_flush", timeout=60)
+        except requests.RequestException as e:
+            logging.warning("[WARN]: unable to flush ingested data (%s)" % e)
+    return results
+
+
+def time_query(job, configfile, export_format, pdf):
+    """Time each stage of the omnistat-query report and export for the job"""
+    from omnistat.query import QueryMetrics
+
+    timings = {}
+
+    def timed(stage, function, *args, **kwargs):
+        start = timeit.default_timer()
+        result = function(*args, **kwargs)
+        timings[stage] = timeit.default_timer() - start
+        logging.info("Query stage %s: %.2f secs" % (stage, timings[stage]))
+        return result
+
+    report = io.StringIO()
+    with tempfile.TemporaryDirectory() as export_path:
+        query = timed("init", QueryMetrics, job.interval, job.job_id, configfile=configfile)
+        timed("find_job_info", query.find_job_info)
+        timed("gather_data", query.gather_data, saveTimeSeries=True)
+        with contextlib.redirect_stdout(report):
+            timed("report", query.generate_report_card)
+        if pdf:
+            timed("pdf", query.generate_pdf, os.path.join(export_path, "report.pdf"))
+        timed("export", query.export, export_path, export_format)
+        export_bytes = sum(f.stat().st_size for f in Path(export_path).iterdir())
+
+    timings["total"] = sum(timings.values())
+    return {
+        "secs": timings,
+        "num_nodes": query.num_nodes_job,
+        "num_gpus": query.num_gpus,
+        "report_bytes": len(report.getvalue()),
+        "export_bytes": export_bytes,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate synthetic Omnistat load and time query reports")
+    parser.add_argument("--nodes", type=int, default=1000, help="number of nodes in the job")
+    parser.add_argument("--gpus", type=int, default=8, help="GPUs per node")
+    parser.add_argument("--nics", type=int, default=4, help="NICs per node")
+    parser.add_argument("--duration", type=parse_duration, default="1d", help="job duration (e.g. 3600, 12h, 3d)")
+    parser.add_argument("--interval", type=float, default=10.0, help="sampling interval in secs")
+    parser.add_argument("--processes", type=int, default=0, help="GPU processes per GPU")
+    parser.add_argument("--counters", type=int, default=0, help="rocprofiler counters per GPU")
+    parser.add_argument("--annotations", type=int, default=0, help="annotation markers per node")
+    parser.add_argument("--steps", type=int, default=0, help="number of job steps (0 = no steps)")
+    parser.add_argument("--vendor", action="store_true", help="include vendor energy counters")
+    parser.add_argument("--seed", type=int, default=0, help="seed for generated values")
+    parser.add_argument("--job", type=str, help="job ID (default: random)")
+    parser.add_argument("--end-time", type=int, help="job end time in epoch secs (default: now)")
+    parser.add_argument("--configfile", type=str, default=CONFIG_FILE, help="omnistat-query configuration file")
+    parser.add_argument("--url", type=str, help="VictoriaMetrics URL (default: prometheus_url in config)")
+    parser.add_argument("--workers", type=int, default=os.cpu_count(), help="number of ingest processes")
+    parser.add_argument("--nodes-per-task", type=int, default=8, help="nodes generated per ingest task")
+    parser.add_argument("--chunk-samples", type=int, default=100000, help="maximum samples per push")
+    parser.add_argument("--compression", choices=["gzip", "none"], default="gzip", help="push compression")
+    parser.add_argument("--retries", type=int, default=2, help="retries per push")
+    parser.add_argument("--skip-ingest", action="store_true", help="query previously ingested job (needs --job)")
+    parser.add_argument("--skip-query", action="store_true", help="only ingest data")
+    parser.add_argument("--dry-run", action="store_true", help="generate and encode samples without a server")
+    parser.add_argument("--export-format", choices=["csv", "parquet"], default="csv", help="export format")
+    parser.add_argument("--pdf", action="store_true", help="include PDF report generation")
+    parser.add_argument("--output", type=str, help="write results (JSON) to file")
+    args = parser.parse_args()
+
+    logging.basicConfig(format="%(message)s", level=logging.INFO, stream=sys.stdout)
+
+    if args.skip_ingest and args.job is None:
+        logging.error("")
+        logging.error("[ERROR]: --skip-ingest requires the --job ID of ingested data")
+        sys.exit(1)
+
+    job = SyntheticJob(
+        args.job or str(uuid.uuid4()),
+        args.nodes,
+        args.gpus,
+        args.nics,
+        args.duration,
+        args.interval,
+        processes=args.processes,
+        counters=args.counters,
+        annotations=args.annotations,
+        steps=args.steps,
+        vendor=args.vendor,
+        seed=args.seed,
+        end_time=args.end_time,
+    )
+
+    url = None
+    if not args.dry_run:
+        url = args.url or readConfig(args.configfile)["omnistat.query"]["prometheus_url"]
+
+    logging.info(
+        "Job %s: %i nodes, %i series/node, %i samples/series (%.0f secs at %.1f sec interval), %i samples total"
+        % (
+            job.job_id,
+            job.num_nodes,
+            job.series_per_node(),
+            job.num_samples,
+            job.duration,
+            job.interval,
+            job.total_samples(),
+        )
+    )
+
+    results = {"job": job.params(), "series": job.num_nodes * job.series_per_node()}
+    if not args.skip_ingest:
+        results["ingest"] = ingest(
+            job, url, args.workers, args.nodes_per_task, args.chunk_samples, args.compression, args.retries
+        )
+        logging.info(
+            "Ingest: %i samples, %.1f MB in %.1f secs (%.0f samples/sec, %i dropped)"
+            % (
+                results["ingest"]["samples"],
+                results["ingest"]["bytes"] / 2**20,
+                results["ingest"]["secs"],
+                results["ingest"]["samples_per_sec"],
+                results["ingest"]["dropped"],
+            )
+        )
+
+    if not args.skip_query and not args.dry_run:
+        results["query"] = time_query(job, args.configfile, args.export_format, args.pdf)
+        logging.info(
+            "Query: %.2f secs total (%s)"
+            % (
+                results["query"]["secs"]["total"],
+                ", ".join(f"{k}={v:.2f}" for k, v in results["query"]["secs"].items() if k != "total"),
+            )
+        )
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(results, f, indent=2)
+        logging.info("Results written to %s" % args.output)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,575 @@
+"""
+Mock device libraries and sysfs trees for exercising Omnistat collectors on
+hosts without GPUs (see benchmark_collectors.py).
+
+- MockSysfs creates a temporary directory mirroring the sysfs/procfs files read
+  by the collectors (network statistics, Cray PM counters, KFD processes, and
+  job detection files). Collectors opening paths under /sys are redirected to
+  this tree with redirect().
+- MockAMDSMI provides the subset of the amdsmi Python module (and its ctypes
+  amdsmi_wrapper bindings) used by the amd_smi, process, and event collectors.
+- MockROCmSMI provides the librocm_smi64 entry points used by the rocm_smi
+  collector, writing results through the ctypes references passed in.
+
+Values are constant across samples; the mocks only reproduce the shape and
+volume of work done by the real libraries.
+"""
+
+import ctypes
+import enum
+import json
+import os
+import pathlib
+import shutil
+import sys
+import tempfile
+import threading
+import types
+
+NUM_CUS = 304
+VRAM_TOTAL_BYTES = 192 * 1024**3
+
+
+class MockSysfs:
+    def __init__(self):
+        self.root = tempfile.mkdtemp(prefix="omnistat-mock-")
+
+    def path(self, path):
+        """Location of an absolute path within the mock tree"""
+        return os.path.join(self.root, str(path).lstrip("/"))
+
+    def write(self, path, contents):
+        path = self.path(path)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "w") as f:
+            f.write(contents)
+        return path
+
+    def add_nics(self, num_nics, num_cxi=0, num_ib=0):
+        """Standard IP interfaces (plus loopback), Slingshot CXI devices, and Infiniband ports"""
+        for name in ["lo"] + ["eth%i" % i for i in range(num_nics)]:
+            self.write("/sys/class/net/%s/statistics/rx_bytes" % name, "123456789\n")
+            self.write("/sys/class/net/%s/statistics/tx_bytes" % name, "987654321\n")
+        buckets = ["27", "35", "36_to_63", "64", "65_to_127", "128_to_255", "256_to_511", "512_to_1023"]
+        buckets += ["1024_to_2047", "2048_to_4095", "4096_to_8191", "8192_to_max"]
+        for i in range(num_cxi):
+            for kind in ["rx", "tx"]:
+                for bucket in buckets:
+                    self.write("/sys/class/cxi/cxi%i/device/telemetry/hni_%s_ok_%s" % (i, kind, bucket), "1000@1.5\n")
+        for i in range(num_ib):
+            self.write("/sys/class/infiniband/mlx5_%i/ports/1/counters/port_rcv_data" % i, "555555\n")
+            self.write("/sys/class/infiniband/mlx5_%i/ports/1/counters/port_xmit_data" % i, "666666\n")
+
+    def add_pm_counters(self, num_gpus):
+        """Cray PM counters for the node and each accelerator"""
+        base = "/sys/cray/pm_counters"
+        for name in ["power", "energy", "cpu_power", "cpu_energy", "memory_power", "memory_energy"]:
+            self.write("%s/%s" % (base, name), "350 %s 1700000000000000 us\n" % ("W" if "power" in name else "J"))
+        for name in ["power_cap", "freshness", "version", "startup"]:
+            self.write("%s/%s" % (base, name), "0\n")
+        for gpu in range(num_gpus):
+            self.write("%s/accel%i_power" % (base, gpu), "500 W 1700000000000000 us\n")
+            self.write("%s/accel%i_energy" % (base, gpu), "123456 J 1700000000000000 us\n")
+        return self.path(base)
+
+    def add_kfd_processes(self, guids, processes_per_gpu):
+        """KFD process entries with CU occupancy for each GPU (one process per GPU and rank)"""
+        base = "/sys/class/kfd/kfd/proc"
+        os.makedirs(self.path(base), exist_ok=True)
+        pid = 10000
+        for guid in guids:
+            for rank in range(processes_per_gpu):
+                self.write("%s/%i/stats_%s/cu_occupancy" % (base, pid, guid), "%i\n" % (NUM_CUS // processes_per_gpu))
+                pid += 1
+        return self.path(base)
+
+    def add_job(self, num_nodes=4):
+        """Job and step detection files (file-based RMS mode)"""
+        job = {
+            "RMS_TYPE": "slurm",
+            "RMS_JOB_ID": "12345",
+            "RMS_JOB_USER": "omnistat",
+            "RMS_JOB_PARTITION": "gpu",
+            "RMS_JOB_NUM_NODES": num_nodes,
+            "RMS_JOB_BATCHMODE": 1,
+        }
+        jobFile = self.write("/tmp/omni_rmsjobinfo", json.dumps(dict(job, RMS_STEP_ID=-1)))
+        stepFile = self.write("/tmp/omni_rmsjobinfo_step", json.dumps(dict(job, RMS_STEP_ID=0)))
+        return jobFile, stepFile
+
+    def redirect(self, *modules):
+        """Resolve pathlib.Path("/sys/...") in the given modules to the mock tree"""
+        real = pathlib.Path
+
+        def Path(*args):
+            path = real(*args)
+            if path.is_absolute() and path.parts[1:2] in (("sys",), ("proc",)):
+                return real(self.path(path))
+            return path
+
+        for module in modules:
+            module.Path = Path
+
+    def cleanup(self):
+        shutil.rmtree(self.root, ignore_errors=True)
+
+
+# --------------------------------------------------------------------------------------
+# amdsmi
+
+# GPU metrics table fields: (name, ctypes type, value); None marks fields unsupported on the device
+GPU_METRICS_FIELDS = [
+    ("temperature_edge", ctypes.c_uint16, None),
+    ("temperature_hotspot", ctypes.c_uint16, 52),
+    ("temperature_mem", ctypes.c_uint16, 44),
+    ("temperature_vrgfx", ctypes.c_uint16, None),
+    ("temperature_vrsoc", ctypes.c_uint16, 41),
+    ("temperature_vrmem", ctypes.c_uint16, 39),
+    ("average_gfx_activity", ctypes.c_uint16, 87),
+    ("average_umc_activity", ctypes.c_uint16, 35),
+    ("average_mm_activity", ctypes.c_uint16, None),
+    ("average_socket_power", ctypes.c_uint16, None),
+    ("energy_accumulator", ctypes.c_uint64, 912345678),
+    ("system_clock_counter", ctypes.c_uint64, 1700000000),
+    ("average_gfxclk_frequency", ctypes.c_uint16, None),
+    ("average_socclk_frequency", ctypes.c_uint16, None),
+    ("average_uclk_frequency", ctypes.c_uint16, 1300),
+    ("average_vclk0_frequency", ctypes.c_uint16, None),
+    ("average_dclk0_frequency", ctypes.c_uint16, None),
+    ("current_gfxclk", ctypes.c_uint16, 2100),
+    ("current_socclk", ctypes.c_uint16, 1143),
+    ("current_uclk", ctypes.c_uint16, 1300),
+    ("current_vclk0", ctypes.c_uint16, 29),
+    ("current_dclk0", ctypes.c_uint16, 22),
+    ("throttle_status", ctypes.c_uint32, None),
+    ("current_fan_speed", ctypes.c_uint16, None),
+    ("pcie_link_width", ctypes.c_uint16, 16),
+    ("pcie_link_speed", ctypes.c_uint16, 320),
+    ("gfx_activity_acc", ctypes.c_uint32, 123456),
+    ("mem_activity_acc", ctypes.c_uint32, 65432),
+    ("firmware_timestamp", ctypes.c_uint64, 1700000000),
+    ("voltage_soc", ctypes.c_uint16, None),
+    ("voltage_gfx", ctypes.c_uint16, None),
+    ("voltage_mem", ctypes.c_uint16, None),
+    ("indep_throttle_status", ctypes.c_uint64, 0),
+    ("current_socket_power", ctypes.c_uint16, 612),
+    ("gfxclk_lock_status", ctypes.c_uint32, 0),
+    ("xgmi_link_width", ctypes.c_uint16, 16),
+    ("xgmi_link_speed", ctypes.c_uint16, 32),
+    ("pcie_bandwidth_acc", ctypes.c_uint64, 987654321),
+    ("pcie_bandwidth_inst", ctypes.c_uint64, 1234),
+    ("pcie_l0_to_recov_count_acc", ctypes.c_uint64, 0),
+    ("pcie_replay_count_acc", ctypes.c_uint64, 0),
+    ("pcie_replay_rover_count_acc", ctypes.c_uint64, 0),
+]
+
+# array fields of the GPU metrics table: (name, ctypes type, length, value)
+GPU_METRICS_ARRAYS = [
+    ("temperature_hbm", ctypes.c_uint16, 4, None),
+    ("vcn_activity", ctypes.c_uint16, 4, 0),
+    ("xgmi_read_data_acc", ctypes.c_uint64, 8, 123456),
+    ("xgmi_write_data_acc", ctypes.c_uint64, 8, 654321),
+    ("current_gfxclks", ctypes.c_uint16, 8, 2100),
+    ("current_socclks", ctypes.c_uint16, 4, 1143),
+    ("current_vclk0s", ctypes.c_uint16, 4, 29),
+    ("current_dclk0s", ctypes.c_uint16, 4, 22),
+]
+
+
+class AmdSmiException(Exception):
+    pass
+
+
+class AmdSmiLibraryException(AmdSmiException):
+    pass
+
+
+class AmdSmiGpuBlock(enum.IntEnum):
+    INVALID = 0
+    UMC = 1
+    SDMA = 2
+    GFX = 4
+    MMHUB = 8
+    ATHUB = 16
+    PCIE_BIF = 32
+    HDP = 64
+    XGMI_WAFL = 128
+    DF = 256
+    SMN = 512
+    SEM = 1024
+    MP0 = 2048
+    MP1 = 4096
+    FUSE = 8192
+
+
+class AmdSmiRasErrState(enum.IntEnum):
+    NONE = 0
+    DISABLED = 1
+    PARITY = 2
+    SING_C = 3
+    MULT_UC = 4
+    POISON = 5
+    ENABLED = 6
+
+
+class AmdSmiTemperatureType(enum.IntEnum):
+    EDGE = 0
+    HOTSPOT = 1
+    VRAM = 2
+    HBM_0 = 3
+    HBM_1 = 4
+    HBM_2 = 5
+    HBM_3 = 6
+    PLX = 7
+
+
+class AmdSmiTemperatureMetric(enum.IntEnum):
+    CURRENT = 0
+    MAX = 1
+    MIN = 2
+
+
+class AmdSmiMemoryType(enum.IntEnum):
+    VRAM = 0
+    VIS_VRAM = 1
+    GTT = 2
+
+
+class AmdSmiEvtNotificationType(enum.IntEnum):
+    NONE = 0
+    VMFAULT = 1
+    THERMAL_THROTTLE = 2
+    GPU_PRE_RESET = 3
+    GPU_POST_RESET = 4
+
+
+ECC_BLOCKS = [AmdSmiGpuBlock.UMC, AmdSmiGpuBlock.SDMA, AmdSmiGpuBlock.GFX, AmdSmiGpuBlock.MMHUB]
+TEMPERATURES = {AmdSmiTemperatureType.HOTSPOT: 52, AmdSmiTemperatureType.VRAM: 44}
+
+
+class MockAMDSMI:
+    """Installs mock amdsmi modules in sys.modules; configure() sets the number of GPUs and processes"""
+
+    def __init__(self):
+        self.num_gpus = 0
+        self.processes_per_gpu = 0
+        self.handles = []
+        self.stopping = threading.Event()
+        self.calls = 0
+
+        self.module = self.build_module()
+        self.wrapper = self.build_wrapper()
+        self.module.amdsmi_wrapper = self.wrapper
+        self.module.amdsmi_interface = types.ModuleType("amdsmi.amdsmi_interface")
+        sys.modules["amdsmi"] = self.module
+        sys.modules["amdsmi.amdsmi_wrapper"] = self.wrapper
+        sys.modules["amdsmi.amdsmi_interface"] = self.module.amdsmi_interface
+
+    def configure(self, num_gpus, processes_per_gpu=0):
+        self.num_gpus = num_gpus
+        self.processes_per_gpu = processes_per_gpu
+        self.handles = [ctypes.c_void_p(0x1000 + gpu) for gpu in range(num_gpus)]
+
+    def guid(self, gpu):
+        return 10000 + gpu
+
+    def gpu(self, handle):
+        return getattr(handle, "value", handle) - 0x1000
+
+    def metrics(self):
+        """GPU metrics table as returned by the Python interface (unsupported fields as "N/A")"""
+        result = {}
+        for name, ctype, value in GPU_METRICS_FIELDS:
+            result[name] = "N/A" if value is None else value
+        for name, ctype, length, value in GPU_METRICS_ARRAYS:
+            result[name] = ["N/A" if value is None else value] * length
+        return result
+
+    def build_module(self):
+        mock = self
+        module = types.ModuleType("amdsmi")
+        for cls in [AmdSmiException, AmdSmiLibraryException, AmdSmiGpuBlock, AmdSmiRasErrState]:
+            setattr(module, cls.__name__, cls)
+        for cls in [AmdSmiTemperatureType, AmdSmiTemperatureMetric, AmdSmiMemoryType, AmdSmiEvtNotificationType]:
+            setattr(module, cls.__name__, cls)
+
+        def amdsmi_init(*args):
+            pass
+
+        def amdsmi_get_lib_version():
+            return {"year": 25, "major": 1, "minor": 0, "release": 0}
+
+        def amdsmi_get_processor_handles():
+            return list(mock.handles)
+
+        def amdsmi_get_gpu_kfd_info(handle):
+            gpu = mock.gpu(handle)
+            return {"kfd_id": mock.guid(gpu), "node_id": gpu + 1, "current_partition_id": 0}
+
+        def amdsmi_get_gpu_vbios_info(handle):
+            return {"name": "MOCK", "build_date": "", "part_number": "113-MOCK-001", "version": "022.040.003"}
+
+        def amdsmi_get_gpu_asic_info(handle):
+            return {"market_name": "Mock Instinct", "vendor_id": "0x1002", "device_id": "0x74a1"}
+
+        def amdsmi_get_gpu_driver_info(handle):
+            return {"driver_name": "amdgpu", "driver_version": "6.10.5", "driver_date": ""}
+
+        def amdsmi_get_gpu_metrics_info(handle):
+            mock.calls += 1
+            return mock.metrics()
+
+        def amdsmi_get_gpu_ecc_status(handle, block):
+            return AmdSmiRasErrState.ENABLED if block in ECC_BLOCKS else AmdSmiRasErrState.DISABLED
+
+        def amdsmi_get_gpu_ecc_count(handle, block):
+            mock.calls += 1
+            if block not in ECC_BLOCKS:
+                raise AmdSmiLibraryException("not supported")
+            return {"correctable_count": 0, "uncorrectable_count": 0, "deferred_count": 0}
+
+        def amdsmi_get_temp_metric(handle, sensor, metric):
+            mock.calls += 1
+            if sensor not in TEMPERATURES:
+                raise AmdSmiLibraryException("not supported")
+            return TEMPERATURES[sensor]
+
+        def amdsmi_get_gpu_memory_total(handle, memoryType):
+            mock.calls += 1
+            return VRAM_TOTAL_BYTES
+
+        def amdsmi_get_gpu_memory_usage(handle, memoryType):
+            mock.calls += 1
+            return VRAM_TOTAL_BYTES // 3
+
+        def amdsmi_get_power_cap_info(handle, sensor=0):
+            mock.calls += 1
+            return {"power_cap": 750000000, "default_power_cap": 750000000, "min_power_cap": 0}
+
+        def amdsmi_get_gpu_process_list(handle):
+            mock.calls += 1
+            return list(range(mock.processes_per_gpu))
+
+        def amdsmi_get_gpu_process_info(handle, process):
+            mock.calls += 1
+            gpu = mock.gpu(handle)
+            return {
+                "name": "mock_app",
+                "pid": 10000 + gpu * mock.processes_per_gpu + process,
+                "mem": 4 * 1024**3,
+                "engine_usage": {"gfx": 123456789, "enc": 0},
+                "memory_usage": {"gtt_mem": 2 * 1024**2, "cpu_mem": 0, "vram_mem": 4 * 1024**3},
+            }
+
+        class AmdSmiEventReader:
+            def __init__(self, handle, eventTypes):
+                self.handle = handle
+
+            def read(self, timeout, num_elem=10):
+                # no events: wait briefly so that the collector can be stopped promptly
+                mock.stopping.wait(min(timeout / 1000, 0.05))
+                raise AmdSmiLibraryException("no events")
+
+            def stop(self):
+                pass
+
+        for name, value in list(locals().items()):
+            if name.startswith("amdsmi_") or name == "AmdSmiEventReader":
+                setattr(module, name, value)
+        module.__all__ = [name for name in dir(module) if not name.startswith("_")]
+        return module
+
+    def build_wrapper(self):
+        mock = self
+        wrapper = types.ModuleType("amdsmi.amdsmi_wrapper")
+
+        fields = [(name, ctype) for name, ctype, value in GPU_METRICS_FIELDS]
+        fields += [(name, ctype * length) for name, ctype, length, value in GPU_METRICS_ARRAYS]
+
+        class amdsmi_gpu_metrics_t(ctypes.Structure):
+            _fields_ = fields
+
+        class amdsmi_error_count_t(ctypes.Structure):
+            _fields_ = [
+                ("correctable_count", ctypes.c_uint64),
+                ("uncorrectable_count", ctypes.c_uint64),
+                ("deferred_count", ctypes.c_uint64),
+            ]
+
+        class amdsmi_power_cap_info_t(ctypes.Structure):
+            _fields_ = [
+                ("power_cap", ctypes.c_uint64),
+                ("default_power_cap", ctypes.c_uint64),
+                ("dpm_cap", ctypes.c_uint64),
+                ("min_power_cap", ctypes.c_uint64),
+                ("max_power_cap", ctypes.c_uint64),
+            ]
+
+        # table contents copied into caller-provided buffers
+        table = amdsmi_gpu_metrics_t()
+        for name, ctype, value in GPU_METRICS_FIELDS:
+            setattr(table, name, (1 << (8 * ctypes.sizeof(ctype))) - 1 if value is None else value)
+        for name, ctype, length, value in GPU_METRICS_ARRAYS:
+            invalid = (1 << (8 * ctypes.sizeof(ctype))) - 1
+            setattr(table, name, (ctype * length)(*([invalid if value is None else value] * length)))
+
+        def amdsmi_get_gpu_metrics_info(handle, ref):
+            mock.calls += 1
+            ctypes.pointer(ref._obj)[0] = table
+            return 0
+
+        def amdsmi_get_temp_metric(handle, sensor, metric, ref):
+            mock.calls += 1
+            ref._obj.value = TEMPERATURES.get(sensor, 0)
+            return 0 if sensor in TEMPERATURES else 2
+
+        def amdsmi_get_gpu_memory_total(handle, memoryType, ref):
+            mock.calls += 1
+            ref._obj.value = VRAM_TOTAL_BYTES
+            return 0
+
+        def amdsmi_get_gpu_memory_usage(handle, memoryType, ref):
+            mock.calls += 1
+            ref._obj.value = VRAM_TOTAL_BYTES // 3
+            return 0
+
+        def amdsmi_get_gpu_ecc_count(handle, block, ref):
+            mock.calls += 1
+            ref._obj.correctable_count = 0
+            ref._obj.uncorrectable_count = 0
+            ref._obj.deferred_count = 0
+            return 0
+
+        def amdsmi_get_power_cap_info(handle, sensor, ref):
+            mock.calls += 1
+            ref._obj.power_cap = 750000000
+            return 0
+
+        for name, value in list(locals().items()):
+            if name.startswith("amdsmi_"):
+                setattr(wrapper, name, value)
+        return wrapper
+
+
+# --------------------------------------------------------------------------------------
+# librocm_smi64
+
+
+class MockROCmSMI:
+    """Stand-in for the ctypes handle of librocm_smi64 (install with patch.object(ctypes, "CDLL", ...))"""
+
+    def __init__(self, num_gpus, version=(7, 4, 0)):
+        self.num_gpus = num_gpus
+        self.version = version
+        self.calls = 0
+        self.tables = {}
+
+    def __call__(self, path, *args, **kwargs):
+        # used in place of ctypes.CDLL
+        return self
+
+    def count(self):
+        self.calls += 1
+        return 0
+
+    @staticmethod
+    def device(device):
+        return getattr(device, "value", device)
+
+    def rsmi_init(self, flags):
+        return 0
+
+    def rsmi_version_get(self, ref):
+        ref._obj.major, ref._obj.minor, ref._obj.patch = self.version
+        return 0
+
+    def rsmi_version_str_get(self, component, buffer, length):
+        buffer.value = b"6.10.5"
+        return 0
+
+    def rsmi_num_monitor_devices(self, ref):
+        ref._obj.value = self.num_gpus
+        return 0
+
+    def rsmi_dev_guid_get(self, device, ref):
+        ref._obj.value = 10000 + self.device(device)
+        return 0
+
+    def rsmi_dev_node_id_get(self, device, ref):
+        ref._obj.value = 1 + self.device(device)
+        return 0
+
+    def rsmi_dev_vbios_version_get(self, device, buffer, length):
+        buffer.value = b"113-MOCK-001"
+        return 0
+
+    def rsmi_dev_name_get(self, device, buffer, length):
+        buffer.value = b"Mock Instinct"
+        return 0
+
+    def rsmi_dev_temp_metric_get(self, device, location, metric, ref):
+        # millidegrees; junction (hotspot) and HBM locations supported
+        values = {1: 52000, 3: 44000}
+        ref._obj.value = values.get(getattr(location, "value", location), 0)
+        return self.count()
+
+    def rsmi_dev_power_get(self, device, ref, typeRef):
+        ref._obj.value = 612000000
+        return self.count()
+
+    def rsmi_dev_power_ave_get(self, device, sensor, ref):
+        ref._obj.value = 612000000
+        return self.count()
+
+    def rsmi_dev_gpu_clk_freq_get(self, device, clock, ref):
+        ref._obj.num_supported = 2
+        ref._obj.current = 1
+        ref._obj.frequency[0] = 500000000
+        ref._obj.frequency[1] = 2100000000 if clock == 0 else 1300000000
+        return self.count()
+
+    def rsmi_dev_memory_total_get(self, device, memoryType, ref):
+        ref._obj.value = VRAM_TOTAL_BYTES
+        return self.count()
+
+    def rsmi_dev_memory_usage_get(self, device, memoryType, ref):
+        ref._obj.value = VRAM_TOTAL_BYTES // 3
+        return self.count()
+
+    def rsmi_dev_memory_busy_percent_get(self, device, ref):
+        ref._obj.value = 35
+        return self.count()
+
+    def rsmi_dev_busy_percent_get(self, device, ref):
+        ref._obj.value = 87
+        return self.count()
+
+    def rsmi_dev_ecc_status_get(self, device, block, ref):
+        # RAS enabled for UMC, SDMA, GFX, and MMHUB blocks
+        ref._obj.value = 6 if block in (0x1, 0x2, 0x4, 0x8) else 1
+        return 0
+
+    def rsmi_dev_ecc_count_get(self, device, block, ref):
+        ref._obj.correctable_err = 0
+        ref._obj.uncorrectable_err = 0
+        return self.count()
+
+    def rsmi_dev_power_cap_get(self, device, sensor, ref):
+        ref._obj.value = 750000000
+        return self.count()
+
+    def rsmi_dev_gpu_metrics_info_get(self, device, ref):
+        table = ref._obj
+        prototype = self.tables.get(type(table))
+        if prototype is None:
+            # populate once per table layout; later calls only copy the table (as the library does)
+            prototype = type(table)()
+            prototype.common_header.format_revision = 1
+            prototype.common_header.content_revision = 3
+            for name, ctype, value in GPU_METRICS_FIELDS:
+                if hasattr(prototype, name):
+                    setattr(prototype, name, (1 << (8 * ctypes.sizeof(ctype))) - 1 if value is None else value)
+            prototype.temperature_hbm[0] = 44
+            self.tables[type(table)] = prototype
+        ctypes.pointer(table)[0] = prototype
+        return self.count()
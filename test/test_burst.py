@@ -0,0 +1,77 @@
+import math
+import time
+
+from omnistat.burst import BurstSampler
+
+
+class Source:
+    """Burst source returning an increasing sequence number (and a NaN column)"""
+
+    def __init__(self):
+        self.count = 0
+
+    def sample(self):
+        self.count += 1
+        return [float(self.count), math.nan]
+
+
+def drain(sampler):
+    samples = []
+    count = sampler.drain(lambda column, timestamp, value: samples.append((column, timestamp, value)))
+    assert count == len(samples)
+    return samples
+
+
+class TestBurstSampler:
+    def sampler(self, window_secs=0.02, capacity_secs=0.03):
+        source = Source()
+        series = [("rocm_average_socket_power_watts", {"card": "0"}), ("rocm_sclk_clock_mhz", {"card": "0"})]
+        sampler = BurstSampler([(series, source.sample)], 0.002, window_secs, capacity_secs)
+        return sampler, source
+
+    def test_no_region(self):
+        sampler, source = self.sampler()
+        sampler.start()
+        time.sleep(0.05)
+        sampler.stop()
+        assert source.count > 0
+        assert drain(sampler) == []
+        assert sampler.regions == 0
+
+    def test_region_drain(self):
+        sampler, source = self.sampler()
+        sampler.start()
+        time.sleep(0.05)
+        begin_ns = time.time_ns()
+        sampler.begin(begin_ns)
+        assert sampler.active
+        # region outlasts the ring: rows are retained until drained
+        time.sleep(0.2)
+        end_ns = time.time_ns()
+        sampler.end(end_ns)
+        time.sleep(0.05)
+        sampler.stop()
+        assert not sampler.active
+
+        samples = drain(sampler)
+        # NaN values are skipped
+        assert {column for column, _, _ in samples} == {0}
+        values = [value for _, _, value in samples]
+        assert values == [values[0] + i for i in range(len(values))]
+        timestamps = [timestamp for _, timestamp, _ in samples]
+        assert timestamps[0] >= (begin_ns - 20_000_000) // 1000000
+        assert timestamps[-1] <= (end_ns + 20_000_000) // 1000000
+        assert len(samples) > 10
+        assert sampler.regions == 1
+        assert sampler.lost == 0
+
+        assert drain(sampler) == []
+
+    def test_lost_history(self):
+        sampler, source = self.sampler()
+        sampler.start()
+        time.sleep(0.1)
+        # requested region starts before the history held by the ring
+        sampler.begin(time.time_ns() - 50_000_000)
+        sampler.stop()
+        assert sampler.lost > 0
@@ -0,0 +1,35 @@
+import os
+import stat
+
+from omnistat.fom import FOMSocket, parse_datagram
+
+
+class TestParseDatagram:
+    def test_samples(self):
+        data = b"throughput 1520.5 1700000000123\nloss 0.25\n"
+        assert parse_datagram(data, 1700000000999) == [
+            {"name": "throughput", "value": "1520.5", "timestamp_msecs": 1700000000123},
+            {"name": "loss", "value": "0.25", "timestamp_msecs": 1700000000999},
+        ]
+
+    def test_malformed(self):
+        data = b"\n   \nthroughput\nthroughput 1 2 3\nloss 0.25 yesterday\nsteps 10\n"
+        assert parse_datagram(data, 1000) == [{"name": "steps", "value": "10", "timestamp_msecs": 1000}]
+
+    def test_invalid_utf8(self):
+        samples = parse_datagram(b"step\xff 1\n", 1000)
+        assert len(samples) == 1
+        assert samples[0]["value"] == "1"
+
+
+class TestFOMSocket:
+    def test_owner_only(self, tmp_path):
+        path = str(tmp_path / "fom.sock")
+        umask = os.umask(0o022)
+        try:
+            receiver = FOMSocket(path, lambda samples: None)
+        finally:
+            os.umask(umask)
+        # no access for group or other users
+        assert stat.S_IMODE(os.stat(path).st_mode) & 0o077 == 0
+        receiver.stop()
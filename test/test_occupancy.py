@@ -0,0 +1,66 @@
+import os
+import shutil
+
+from omnistat.occupancy import RETRY_SCANS, OccupancyScanner
+
+
+def write_occupancy(base, pid, guid, value):
+    path = os.path.join(base, str(pid), "stats_%s" % guid)
+    os.makedirs(path, exist_ok=True)
+    with open(os.path.join(path, "cu_occupancy"), "w") as f:
+        f.write("%i\n" % value)
+
+
+class TestOccupancyScanner:
+    def test_totals_and_processes(self, tmp_path):
+        base = str(tmp_path)
+        write_occupancy(base, 100, 1001, 10)
+        write_occupancy(base, 100, 1002, 0)
+        write_occupancy(base, 200, 1001, 5)
+        scanner = OccupancyScanner([1001, 1002], base_path=base)
+
+        assert scanner.scan() == {1001: 15, 1002: 0}
+        # only non-zero occupancy is reported per process
+        assert scanner.processes == {"100": {1001: 10}, "200": {1001: 5}}
+
+        # open files are re-read on each scan
+        write_occupancy(base, 100, 1002, 7)
+        assert scanner.scan() == {1001: 15, 1002: 7}
+        scanner.close()
+
+    def test_process_lifecycle(self, tmp_path):
+        base = str(tmp_path)
+        write_occupancy(base, 100, 1001, 10)
+        scanner = OccupancyScanner([1001], base_path=base)
+        assert scanner.scan() == {1001: 10}
+
+        # new processes are discovered, exited processes are released
+        write_occupancy(base, 200, 1001, 4)
+        shutil.rmtree(os.path.join(base, "100"))
+        assert scanner.scan() == {1001: 4}
+        assert scanner.processes == {"200": {1001: 4}}
+        scanner.close()
+
+    def test_additional_gpu(self, tmp_path):
+        base = str(tmp_path)
+        write_occupancy(base, 100, 1001, 10)
+        scanner = OccupancyScanner([1001, 1002], base_path=base)
+        scanner.scan()
+
+        # GPUs used after a process is first seen are picked up on retry scans
+        write_occupancy(base, 100, 1002, 3)
+        totals = None
+        for i in range(RETRY_SCANS):
+            totals = scanner.scan()
+        assert totals == {1001: 10, 1002: 3}
+        scanner.close()
+
+    def test_max_age(self, tmp_path):
+        base = str(tmp_path)
+        write_occupancy(base, 100, 1001, 10)
+        scanner = OccupancyScanner([1001], base_path=base)
+        scanner.scan()
+        write_occupancy(base, 100, 1001, 20)
+        assert scanner.scan(max_age=60.0) == {1001: 10}
+        assert scanner.scan() == {1001: 20}
+        scanner.close()
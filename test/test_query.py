@@ -314,3 +314,48 @@ class TestQuery:
                         assert (
                             value == nostep_gpu_value
                         ), f"Unexpected {metric} sample value at position {i} in {job.time_series[metric][gpu_id]['values']}"
+
+    # Validate report values for data rolled up on-node (rollup_secs): source
+    # series hold window means, while maxima and energy are read from the
+    # derived <metric>_max and cumulative energy series.
+    @pytest.mark.parametrize("server_side_aggregation", [False, True])
+    def test_rollup_report(self, server_side_aggregation):
+        job_id = uuid.uuid4()
+        duration = 60
+        interval = 1.0
+        num_nodes = 2
+        gpu_values = [25.0, 50.0]
+        peak_values = [80.0, 90.0]
+        joules_per_sample = 500.0
+
+        trace = TraceGenerator(duration, interval, job_id, num_nodes)
+        trace.add_constant_load("all", num_nodes, gpu_values)
+        metrics = trace.generate()
+
+        for i in range(num_nodes):
+            node = f"node-{i}.all.{job_id}"
+            for gpu_id, peak in enumerate(peak_values):
+                labels = f'instance="{node}",card="{gpu_id}"'
+                for name in GPU_METRIC_NAMES:
+                    metrics.extend(f"{name}_max{{{labels}}} {peak} {t}" for t in trace.sample_times)
+                metrics.extend(
+                    f"rocm_average_socket_power_energy_joules{{{labels}}} {j * joules_per_sample} {t}"
+                    for j, t in enumerate(trace.sample_times)
+                )
+
+        push_to_victoria_metrics(metrics, URL)
+
+        query = QueryMetrics(interval, job_id, configfile=CONFIG_FILE)
+        query.config["server_side_aggregation"] = server_side_aggregation
+        query.find_job_info()
+        query.gather_data()
+
+        expected_energy_kwh = (len(trace.sample_times) - 1) * joules_per_sample / (1000 * 3600)
+        for gpu_id in range(len(gpu_values)):
+            for metric in GPU_METRIC_NAMES:
+                assert query.stats[f"{metric}_max"][gpu_id] == peak_values[gpu_id], f"Unexpected max for {metric}"
+                assert query.stats[f"{metric}_mean"][gpu_id] == gpu_values[gpu_id], f"Unexpected mean for {metric}"
+            energy_per_host = query.energyStats_kwh[gpu_id]
+            assert len(energy_per_host) == num_nodes
+            for energy in energy_per_host:
+                assert energy == pytest.approx(expected_energy_kwh, rel=0.05), "Unexpected energy"
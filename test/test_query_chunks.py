@@ -0,0 +1,137 @@
+import re
+from datetime import datetime, timedelta
+
+import pytest
+
+from omnistat.query import QueryMetrics
+
+HOSTS = ["node1.cluster", "node10.cluster", "node2.cluster", "node3.cluster", "node4.cluster"]
+
+
+class MockPrometheus:
+    """Stand-in for PrometheusConnect: one series per host, with a value derived from host and time"""
+
+    def __init__(self, hosts):
+        self.hosts = hosts
+        self.requests = 0
+
+    def custom_query_range(self, query, start, end, step, params=None):
+        self.requests += 1
+        hosts = self.hosts
+        match = re.search(r'instance=~"((?:[^"\\]|\\.)*)"', query)
+        if match:
+            # unescape the PromQL string; regex matches are anchored as in PromQL
+            pattern = re.sub(r"\\(.)", r"\1", match.group(1))
+            hosts = [host for host in hosts if re.fullmatch(pattern, host)]
+        results = []
+        for host in hosts:
+            values = []
+            t = start.timestamp()
+            while t <= end.timestamp() + 1e-6:
+                values.append([t, str(self.hosts.index(host) * 1000 + t % 1000)])
+                t += step
+            results.append({"metric": {"__name__": "metric", "instance": host}, "values": values})
+        return results
+
+
+def query_metrics(tmp_path, max_points, max_hosts):
+    config = tmp_path / ("omnistat-%i-%i.config" % (max_points, max_hosts))
+    config.write_text(
+        "[omnistat.query]\n"
+        "prometheus_url = http://localhost:8428\n"
+        "max_points_per_query = %i\n"
+        "max_hosts_per_query = %i\n"
+        "max_concurrent_queries = 2\n" % (max_points, max_hosts)
+    )
+    query = QueryMetrics(1.0, "1", configfile=str(config))
+    query.prometheus = MockPrometheus(HOSTS)
+    query.start_time = datetime(2025, 1, 1, 0, 0, 0)
+    query.end_time = query.start_time + timedelta(seconds=95)
+    query.hosts = HOSTS
+    return query
+
+
+def by_instance(results):
+    return {result["metric"]["instance"]: result["values"] for result in results}
+
+
+class TestTimeChunks:
+    @pytest.mark.parametrize("seconds, max_points", [(95, 10), (99, 10), (100, 10), (9, 10), (10, 10), (95, 1)])
+    def test_chunks_cover_range(self, tmp_path, seconds, max_points):
+        query = query_metrics(tmp_path, max_points, 0)
+        start = query.start_time
+        end = start + timedelta(seconds=seconds)
+        chunks = query.time_chunks(start, end, 1.0)
+
+        assert chunks[0][0] == start
+        assert chunks[-1][1] == end
+        for chunk_start, chunk_end in chunks:
+            assert (chunk_end - chunk_start).total_seconds() + 1 <= max_points
+        # consecutive chunks are one step apart: no repeated or skipped evaluation timestamps
+        for (_, previous_end), (next_start, _) in zip(chunks, chunks[1:]):
+            assert next_start - previous_end == timedelta(seconds=1)
+
+
+class TestHostShards:
+    def test_shards_partition_hosts(self, tmp_path):
+        query = query_metrics(tmp_path, 0, 2)
+        shards = query.host_shards()
+        assert [len(shard) for shard in shards] == [2, 2, 1]
+        assert [host for shard in shards for host in shard] == HOSTS
+
+    def test_single_shard(self, tmp_path):
+        assert query_metrics(tmp_path, 0, len(HOSTS)).host_shards() == [None]
+        assert query_metrics(tmp_path, 0, 0).host_shards() == [None]
+
+
+class TestMergeResults:
+    def test_duplicate_boundary_samples(self, tmp_path):
+        query = query_metrics(tmp_path, 0, 0)
+        series = {"__name__": "metric", "instance": "node1.cluster"}
+        responses = [
+            [{"metric": dict(series), "values": [[1, "1"], [2, "2"], [3, "3"]]}],
+            [{"metric": dict(series), "values": [[3, "3"], [4, "4"]]}],
+            [{"metric": dict(series), "values": []}],
+            [{"metric": dict(series), "values": [[5, "5"]]}],
+        ]
+        merged = query.merge_results(responses)
+        assert len(merged) == 1
+        assert merged[0]["values"] == [[t, str(t)] for t in range(1, 6)]
+
+    def test_labels_in_any_order(self, tmp_path):
+        query = query_metrics(tmp_path, 0, 0)
+        responses = [
+            [{"metric": {"card": "0", "instance": "a"}, "values": [[1, "1"]]}],
+            [{"metric": {"instance": "a", "card": "0"}, "values": [[2, "2"]]}],
+            [{"metric": {"instance": "a", "card": "1"}, "values": [[2, "2"]]}],
+        ]
+        merged = query.merge_results(responses)
+        assert len(merged) == 2
+        assert merged[0]["values"] == [[1, "1"], [2, "2"]]
+
+
+class TestChunkedQuery:
+    @pytest.mark.parametrize("max_points, max_hosts", [(10, 0), (0, 2), (10, 2), (7, 3), (1, 1)])
+    def test_matches_unchunked(self, tmp_path, max_points, max_hosts):
+        template = "metric * on (instance) group_left() (max by (instance) (rmsjob_info{$job,$step}))"
+        expected = query_metrics(tmp_path, 0, 0)
+        chunked = query_metrics(tmp_path, max_points, max_hosts)
+
+        expected_results = expected.query_job_range(template, shard_hosts=True)
+        chunked_results = chunked.query_job_range(template, shard_hosts=True)
+        assert expected.prometheus.requests == 1
+        assert chunked.prometheus.requests > 1
+
+        # every host is returned once, with the same samples as a single query
+        assert sorted(result["metric"]["instance"] for result in chunked_results) == sorted(HOSTS)
+        assert by_instance(chunked_results) == by_instance(expected_results)
+
+    def test_streamed_parts_match_unchunked(self, tmp_path):
+        template = "metric * on (instance) group_left() (max by (instance) (rmsjob_info{$job,$step}))"
+        expected = query_metrics(tmp_path, 0, 0)
+        chunked = query_metrics(tmp_path, 10, 2)
+
+        parts = list(chunked.query_job_range_chunks(template, shard_hosts=True))
+        assert len(parts) == 3 * 10
+        merged = by_instance(chunked.merge_results(parts))
+        assert merged == by_instance(expected.query_job_range(template, shard_hosts=True))
@@ -0,0 +1,90 @@
+import pytest
+
+from omnistat.rollup import Rollup, parse_thresholds
+
+
+def flush(rollup):
+    emitted = []
+    count = rollup.flush(
+        lambda seriesId, suffix, timestamp, value: emitted.append((seriesId, suffix, timestamp, value))
+    )
+    assert count == len(emitted)
+    return emitted
+
+
+class TestRollup:
+    def test_gauge_statistics(self):
+        rollup = Rollup(10.0)
+        rollup.track(0, "rocm_temperature_celsius", {"card": "0"}, "gauge")
+        for timestamp, value in [(0, 40.0), (1000, 60.0), (2000, 50.0)]:
+            rollup.add(0, timestamp, value)
+
+        assert flush(rollup) == [
+            (0, "", 2000, 50.0),
+            (0, "_min", 2000, 40.0),
+            (0, "_max", 2000, 60.0),
+            (0, "_last", 2000, 50.0),
+        ]
+        # statistics are reset for the next window
+        assert flush(rollup) == []
+        rollup.add(0, 3000, 70.0)
+        assert flush(rollup) == [
+            (0, "", 3000, 70.0),
+            (0, "_min", 3000, 70.0),
+            (0, "_max", 3000, 70.0),
+            (0, "_last", 3000, 70.0),
+        ]
+
+    def test_counter_last_value(self):
+        rollup = Rollup(10.0)
+        rollup.track(0, "omnistat_network_rx_bytes", {"interface": "hsn0"}, "counter")
+        rollup.add(0, 0, 100.0)
+        rollup.add(0, 1000, 250.0)
+        assert flush(rollup) == [(0, "", 1000, 250.0)]
+
+    def test_trapezoid_energy(self):
+        rollup = Rollup(10.0)
+        rollup.track(0, "rocm_average_socket_power_watts", {"card": "0"}, "gauge")
+        for timestamp, value in [(0, 100.0), (1000, 200.0), (3000, 200.0)]:
+            rollup.add(0, timestamp, value)
+        energy = [entry for entry in flush(rollup) if entry[1] == "_energy_joules"]
+        # 0.5 * (100 + 200) * 1s + 200 * 2s
+        assert energy == [(0, "_energy_joules", 3000, 550.0)]
+        assert rollup.derived_name(0, "_energy_joules") == "rocm_average_socket_power_energy_joules"
+
+        # energy is cumulative across windows, including the interval between windows
+        rollup.add(0, 4000, 100.0)
+        energy = [entry for entry in flush(rollup) if entry[1] == "_energy_joules"]
+        assert energy == [(0, "_energy_joules", 4000, 700.0)]
+
+    def test_raw_threshold(self):
+        rollup = Rollup(10.0, parse_thresholds("rocm_temperature_celsius>90"))
+        rollup.track(0, "rocm_temperature_celsius", {"card": "0"}, "gauge")
+        rollup.add(0, 0, 80.0)
+        rollup.add(0, 1000, 85.0)
+        assert [entry for entry in flush(rollup) if entry[1] == ""] == [(0, "", 1000, 82.5)]
+
+        # raw samples replace the mean in windows where the threshold is crossed
+        rollup.add(0, 2000, 80.0)
+        rollup.add(0, 3000, 95.0)
+        assert [entry for entry in flush(rollup) if entry[1] == ""] == [(0, "", 2000, 80.0), (0, "", 3000, 95.0)]
+
+    def test_next_boundary(self):
+        rollup = Rollup(10.0)
+        assert rollup.window_ns == 10_000_000_000
+        assert rollup.next_boundary(0) == 10_000_000_000
+        assert rollup.next_boundary(15_000_000_000) == 20_000_000_000
+
+
+class TestParseThresholds:
+    def test_operators(self):
+        thresholds = parse_thresholds("rocm_temperature_celsius>=90, rocm_sclk_clock_mhz < 500")
+        compare, value = thresholds["rocm_temperature_celsius"]
+        assert value == 90.0 and compare(90.0, value)
+        compare, value = thresholds["rocm_sclk_clock_mhz"]
+        assert value == 500.0 and compare(400.0, value) and not compare(500.0, value)
+        assert parse_thresholds("") == {}
+
+    def test_invalid(self):
+        with pytest.raises(ValueError):
+            parse_thresholds("rocm_temperature_celsius=90")
@@ -0,0 +1,100 @@
+from omnistat.sample_buffer import GROW_STEP, SampleBlock, SampleBuffer
+
+
+def cache(buffer, samples):
+    for name, timestamp, value in samples:
+        seriesId = buffer.lookup(name)
+        if seriesId is None:
+            seriesId = buffer.addSeries(name, '%s{instance="node01"}' % name)
+        buffer.append(seriesId, timestamp, value)
+
+
+class TestSampleBuffer:
+    def test_intern_series(self):
+        buffer = SampleBuffer()
+        assert buffer.lookup("rocm_temperature_celsius") is None
+        cache(buffer, [("rocm_temperature_celsius", 1000, 40.0), ("rocm_temperature_celsius", 2000, 41.0)])
+        assert buffer.lookup("rocm_temperature_celsius") == 0
+        assert buffer.numSeries() == 1
+        assert len(buffer) == 2
+
+    def test_lines(self):
+        buffer = SampleBuffer()
+        cache(buffer, [("rocm_temperature_celsius", 1000, 40.0), ("rocm_num_gpus", 1000, 8)])
+        block = buffer.drain()
+        assert list(buffer.lines(block)) == [
+            'rocm_temperature_celsius{instance="node01"} 40.0 1000',
+            'rocm_num_gpus{instance="node01"} 8.0 1000',
+        ]
+
+    def test_double_buffer_swap(self):
+        buffer = SampleBuffer(capacity=4)
+        cache(buffer, [("a", 1000, 1.0), ("b", 1000, 2.0)])
+        first = buffer.drain()
+        assert first.count == 2
+        assert len(buffer) == 0
+
+        # samples cached while a drained block is pushed do not modify it
+        cache(buffer, [("a", 2000, 3.0)])
+        assert list(buffer.lines(first)) == ['a{instance="node01"} 1.0 1000', 'b{instance="node01"} 2.0 1000']
+
+        # a released block is reused as the next active block
+        buffer.release(first)
+        second = buffer.drain()
+        assert second is not first
+        assert list(buffer.lines(second)) == ['a{instance="node01"} 3.0 2000']
+        cache(buffer, [("b", 3000, 4.0)])
+        buffer.release(second)
+        third = buffer.drain()
+        assert third is first
+        assert list(buffer.lines(third)) == ['b{instance="node01"} 4.0 3000']
+
+    def test_grow(self):
+        buffer = SampleBuffer(capacity=2)
+        cache(buffer, [("a", timestamp, float(timestamp)) for timestamp in range(10)])
+        block = buffer.drain()
+        assert block.count == 10
+        assert block.capacity >= 10
+        assert [line.split()[-1] for line in buffer.lines(block)] == [str(timestamp) for timestamp in range(10)]
+
+    def test_expire(self):
+        buffer = SampleBuffer()
+        cache(buffer, [("a", 1000, 1.0), ("b", 1000, 2.0)])
+        buffer.drain()
+        assert buffer.expire() == []
+
+        # series not cached (or touched) since the previous push are dropped
+        cache(buffer, [("a", 2000, 3.0)])
+        buffer.touch(buffer.lookup("b"))
+        block = buffer.drain()
+        assert buffer.expire() == []
+        cache(buffer, [("a", 3000, 4.0)])
+        buffer.release(block)
+        block = buffer.drain()
+        assert buffer.expire() == [1]
+        assert buffer.lookup("b") is None
+        assert buffer.numSeries() == 1
+
+        # expired series are interned again (with a new id) when observed
+        cache(buffer, [("b", 4000, 5.0)])
+        assert buffer.lookup("b") == 2
+        buffer.release(block)
+        block = buffer.drain()
+        assert list(buffer.lines(block)) == ['b{instance="node01"} 5.0 4000']
+        assert buffer.expire() == [0]
+
+
+class TestSampleBlock:
+    def test_reserve(self):
+        block = SampleBlock(4)
+        block.reserve(2)
+        assert block.capacity == 4
+        block.reserve(16)
+        assert block.capacity == 16
+        assert len(block.ids) == len(block.timestamps) == len(block.values) == 16
+
+    def test_reserve_steps(self):
+        block = SampleBlock(1)
+        block.reserve(2 * GROW_STEP + 3)
+        assert len(block.ids) == len(block.timestamps) == len(block.values) == 2 * GROW_STEP + 3
+        assert block.values[-1] == 0.0 and block.ids[GROW_STEP] == 0
@@ -0,0 +1,31 @@
+import time
+
+from omnistat.scheduler import DeadlineScheduler
+
+
+class TestDeadlineScheduler:
+    def test_aligned_deadlines(self):
+        interval_ns = 10_000_000
+        scheduler = DeadlineScheduler(0.01)
+        before = time.time_ns()
+        deadline = scheduler.start()
+        assert deadline % interval_ns == 0
+        assert before < deadline <= before + interval_ns
+        assert time.time_ns() >= deadline
+
+        for i in range(5):
+            assert scheduler.wait() == 0 or scheduler.overruns > 0
+            assert scheduler.deadline_ns % interval_ns == 0
+            assert time.time_ns() >= scheduler.deadline_ns
+        assert scheduler.deadline_ns >= deadline + 5 * interval_ns
+
+    def test_skipped_deadlines(self):
+        scheduler = DeadlineScheduler(0.01)
+        deadline = scheduler.start()
+        # overrun by several intervals: intervening deadlines are skipped, preserving alignment
+        time.sleep(0.055)
+        skipped = scheduler.wait()
+        assert skipped >= 4
+        assert scheduler.missed == skipped
+        assert scheduler.overruns == 1
+        assert scheduler.deadline_ns == deadline + (skipped + 1) * 10_000_000
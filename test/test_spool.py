@@ -0,0 +1,119 @@
+import os
+import time
+
+from omnistat.spool import Spool, spool_directory
+
+
+class Receiver:
+    def __init__(self, fail=0):
+        self.payloads = []
+        self.fail = fail
+
+    def send(self, payload, compressed):
+        if self.fail > 0:
+            self.fail -= 1
+            return False
+        self.payloads.append((payload, compressed))
+        return True
+
+
+class TestSpoolDirectory:
+    def test_private_per_job_and_endpoint(self):
+        base = spool_directory("/spool", "user", "100", "http://server:8428")
+        assert base.startswith("/spool/user/100-")
+        assert spool_directory("/spool", "user", "101", "http://server:8428") != base
+        assert spool_directory("/spool", "user", "100", "http://other:8428") != base
+        assert spool_directory("/spool", "user", "100", "http://server:8428") == base
+
+
+class TestSpool:
+    def test_delivery_order(self, tmp_path):
+        receiver = Receiver()
+        spool = Spool(str(tmp_path), 1 << 20, "node", receiver.send)
+        for i in range(5):
+            spool.write(b"payload%i" % i, compressed=(i % 2 == 1))
+        spool.start()
+        spool.stop()
+        assert receiver.payloads == [(b"payload%i" % i, i % 2 == 1) for i in range(5)]
+        assert spool.delivered == 5
+        assert spool.pending == 0
+        assert os.listdir(tmp_path) == []
+
+    def test_evicts_oldest(self, tmp_path):
+        receiver = Receiver()
+        spool = Spool(str(tmp_path), 25, "node", receiver.send)
+        for i in range(5):
+            spool.write(b"%010i" % i, compressed=False)
+        # capacity holds two 10-byte segments
+        assert spool.dropped == 3
+        assert spool.pending == 2
+        spool.start()
+        spool.stop()
+        assert receiver.payloads == [(b"%010i" % 3, False), (b"%010i" % 4, False)]
+
+    def test_keeps_oversized_segment(self, tmp_path):
+        spool = Spool(str(tmp_path), 4, "node", Receiver().send)
+        spool.write(b"0123456789", compressed=False)
+        assert spool.pending == 1
+        assert spool.dropped == 0
+
+    def test_failed_delivery_is_retained(self, tmp_path):
+        receiver = Receiver(fail=1000)
+        spool = Spool(str(tmp_path), 1 << 20, "node", receiver.send)
+        spool.write(b"first", compressed=False)
+        spool.write(b"second", compressed=False)
+        spool.start()
+        spool.stop()
+        assert receiver.payloads == []
+        assert spool.pending == 2
+        assert len(os.listdir(tmp_path)) == 2
+
+    def test_retry_preserves_order(self, tmp_path):
+        receiver = Receiver(fail=1)
+        spool = Spool(str(tmp_path), 1 << 20, "node", receiver.send)
+        spool.write(b"first", compressed=False)
+        spool.write(b"second", compressed=False)
+        spool.start()
+        deadline = time.monotonic() + 10
+        while spool.pending and time.monotonic() < deadline:
+            time.sleep(0.05)
+        spool.stop()
+        assert receiver.payloads == [(b"first", False), (b"second", False)]
+
+    def test_replay(self, tmp_path):
+        # segments left behind by a previous run that was not able to deliver them
+        spool = Spool(str(tmp_path), 1 << 20, "node", Receiver().send)
+        for i in range(3):
+            spool.write(b"payload%i" % i, compressed=True)
+
+        # leftovers from an interrupted write and segments from other hosts are ignored
+        (tmp_path / "node-00000000000000000000-000000.prom.tmp").write_bytes(b"partial")
+        (tmp_path / "other-00000000000000000000-000000.prom").write_bytes(b"other")
+
+        receiver = Receiver()
+        spool = Spool(str(tmp_path), 1 << 20, "node", receiver.send)
+        assert spool.pending == 3
+        spool.write(b"payload3", compressed=False)
+        spool.start()
+        spool.stop()
+        assert receiver.payloads == [(b"payload%i" % i, True) for i in range(3)] + [(b"payload3", False)]
+
+    def test_replay_respects_capacity(self, tmp_path):
+        spool = Spool(str(tmp_path), 1 << 20, "node", Receiver().send)
+        for i in range(4):
+            spool.write(b"%010i" % i, compressed=False)
+
+        receiver = Receiver()
+        spool = Spool(str(tmp_path), 25, "node", receiver.send)
+        assert spool.dropped == 2
+        spool.start()
+        spool.stop()
+        assert receiver.payloads == [(b"%010i" % 2, False), (b"%010i" % 3, False)]
+
+    def test_notify(self, tmp_path):
+        notified = []
+        spool = Spool(str(tmp_path), 1 << 20, "node", Receiver().send, notify=lambda: notified.append(True))
+        spool.write(b"payload", compressed=False)
+        spool.start()
+        spool.stop()
+        assert notified == [True]